@@ -0,0 +1,7 @@
+; ATmega328: toggle PB5 as fast as possible (avr_loop.hex)
+; avra / avr-as syntax
+
+        ldi  r16, 0x20      ; PB5
+        out  0x04, r16      ; DDRB: PB5 output
+loop:   out  0x03, r16      ; PINB: toggle PB5
+        rjmp loop
@@ -0,0 +1,46 @@
+; ATmega328 at 16 MHz: UART and I2C traffic (avr_uart_i2c.hex)
+; Sends a byte by UART at 111 kbaud (TX looped to RX in the circuit),
+; then writes it to the I2C RAM at address 0x50, 400 kHz. Forever.
+; avra / avr-as syntax
+
+        ldi  r16, 0x08
+        out  0x3E, r16      ; SPH
+        ldi  r16, 0xFF
+        out  0x3D, r16      ; SPL: stack at 0x08FF
+        ldi  r16, 8
+        sts  0xC4, r16      ; UBRR0L = 8
+        ldi  r16, 0x18
+        sts  0xC1, r16      ; UCSR0B = RXEN0 | TXEN0
+        ldi  r16, 12
+        sts  0xB8, r16      ; TWBR = 12: 400 kHz
+        ldi  r17, 0x55      ; Data
+
+loop:
+uart:   lds  r16, 0xC0      ; UCSR0A
+        sbrs r16, 5         ; UDRE0
+        rjmp uart
+        sts  0xC6, r17      ; UDR0
+
+        ldi  r16, 0xA4      ; TWINT | TWSTA | TWEN: Start
+        sts  0xBC, r16
+        rcall twi_wait
+        ldi  r16, 0xA0      ; SLA+W
+        sts  0xBB, r16      ; TWDR
+        ldi  r16, 0x84      ; TWINT | TWEN
+        sts  0xBC, r16
+        rcall twi_wait
+        sts  0xBB, r17      ; Data
+        ldi  r16, 0x84
+        sts  0xBC, r16
+        rcall twi_wait
+        ldi  r16, 0x94      ; TWINT | TWSTO | TWEN: Stop
+        sts  0xBC, r16
+
+        inc  r17
+        rjmp loop
+
+twi_wait:
+        lds  r16, 0xBC      ; TWCR
+        sbrs r16, 7         ; TWINT
+        rjmp twi_wait
+        ret
@@ -0,0 +1,16 @@
+
+TEMPLATE = app
+TARGET = eventqueue_bench
+
+QT = core
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG *= c++11
+
+INCLUDEPATH += $$PWD/../../src/simulator
+
+SOURCES = $$PWD/main.cpp
+HEADERS = $$PWD/../../src/simulator/eventqueue.h
+
+QMAKE_CXXFLAGS += -O2
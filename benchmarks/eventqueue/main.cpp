@@ -0,0 +1,117 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+// Event queue microbenchmark:
+// Keeps N events pending and measures reschedules per second,
+// heap scheduler (EventQueue) against the old sorted linked list.
+
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <vector>
+
+#include "eventqueue.h"
+
+// Minimal eElement, we don't want the whole simulator here.
+eElement::eElement( QString id )
+{
+    m_elmId = id;
+    nextChanged = nullptr;
+    eventTime  = 0;
+    eventOrder = 0;
+    eventIndex = -1;
+}
+eElement::~eElement(){}
+void  eElement::setNumEpins( int ){}
+ePin* eElement::getEpin( int ){ return nullptr; }
+void  eElement::setEpin( int, ePin* ){}
+
+class SortedList // Old Simulator::addEvent implementation
+{
+    public:
+        SortedList( int n ){ m_first = -1; m_next.resize( n, -1 ); m_time.resize( n, 0 ); }
+
+        void insert( int el, uint64_t time )
+        {
+            int last  = -1;
+            int event = m_first;
+            while( event >= 0 ){
+                if( time <= m_time[event] ) break;
+                last  = event;
+                event = m_next[event];
+            }
+            m_time[el] = time;
+            if( last >= 0 ) m_next[last] = el;
+            else            m_first = el;
+            m_next[el] = event;
+        }
+        int pop()
+        {
+            int el = m_first;
+            m_first = m_next[el];
+            m_next[el] = -1;
+            return el;
+        }
+        uint64_t time( int el ) { return m_time[el]; }
+
+    private:
+        int m_first;
+        std::vector<int> m_next;
+        std::vector<uint64_t> m_time;
+};
+
+static uint32_t rnd() // Deterministic LCG
+{
+    static uint32_t seed = 12345;
+    seed = seed*1103515245+12345;
+    return seed>>8;
+}
+
+int main()
+{
+    QTextStream out( stdout );
+    out << "pending      heap ev/s      list ev/s\n";
+
+    const int numOps = 2000000;
+
+    for( int pending : { 8, 32, 128, 512, 2048, 8192 } )
+    {
+        std::vector<eElement*> elements;
+        for( int i=0; i<pending; ++i ) elements.push_back( new eElement("el"+QString::number(i)) );
+
+        EventQueue queue;
+        for( eElement* el : elements ) queue.insert( el, 1+rnd()%1000000 );
+
+        QElapsedTimer timer;
+        timer.start();
+        for( int i=0; i<numOps; ++i )
+        {
+            eElement* el = queue.first();
+            uint64_t time = el->eventTime;
+            queue.pop();
+            queue.insert( el, time+1+rnd()%1000000 );
+        }
+        double heapRate = numOps*1e9/timer.nsecsElapsed();
+
+        SortedList list( pending );
+        for( int i=0; i<pending; ++i ) list.insert( i, 1+rnd()%1000000 );
+
+        int listOps = numOps/(1+pending/64); // Keep list runs short
+        timer.restart();
+        for( int i=0; i<listOps; ++i )
+        {
+            int el = list.pop();
+            list.insert( el, list.time( el )+1+rnd()%1000000 );
+        }
+        double listRate = listOps*1e9/timer.nsecsElapsed();
+
+        out << QString::number( pending ).rightJustified( 7 )
+            << QString::number( heapRate, 'e', 3 ).rightJustified( 15 )
+            << QString::number( listRate, 'e', 3 ).rightJustified( 15 ) << "\n";
+
+        queue.clear();
+        for( eElement* el : elements ) delete el;
+    }
+    return 0;
+}
@@ -0,0 +1,261 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+// Dense matrix update microbenchmark:
+// Two small circuits where a few switches toggle all the time,
+// stamped the same way eNodes do it in CircMatrix.
+// Runs each one with full refactorization only and with partial/rank-k updates.
+
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <vector>
+#include <cmath>
+
+#include "denselu.h"
+#include "simdkernels.h"
+
+struct Branch { int a; int b; double admit; }; // Node -1 is ground
+
+class Net
+{
+    public:
+        Net( int nodes ) { m_nodes = nodes; m_curr.assign( nodes, 0 ); m_dirty.assign( nodes, true ); }
+
+        int addBranch( int a, int b, double admit )
+        {
+            m_branches.push_back( { a, b, admit } );
+            return m_branches.size()-1;
+        }
+        void setAdmit( int branch, double admit )
+        {
+            Branch& br = m_branches[branch];
+            if( br.admit == admit ) return;
+            br.admit = admit;
+            if( br.a >= 0 ) m_dirty[br.a] = true;
+            if( br.b >= 0 ) m_dirty[br.b] = true;
+        }
+        void setCurrent( int node, double curr ) { m_curr[node] = curr; }
+
+        bool stamp( DenseLU* lu ) // Stamp changed nodes, write changed values only, like CircMatrix
+        {
+            bool changed = false;
+            std::vector<double> row( m_nodes );
+            for( int i=0; i<m_nodes; ++i )
+            {
+                if( !m_dirty[i] ) continue;
+                m_dirty[i] = false;
+
+                for( double& v : row ) v = 0;
+                for( const Branch& br : m_branches )
+                {
+                    int other;
+                    if     ( br.a == i ) other = br.b;
+                    else if( br.b == i ) other = br.a;
+                    else continue;
+                    row[i] += br.admit;
+                    if( other >= 0 ) row[other] -= br.admit;
+                }
+                double* stampRow = lu->row( i );
+                for( int j=0; j<m_nodes; ++j )
+                {
+                    if( stampRow[j] == row[j] ) continue;
+                    stampRow[j] = row[j];
+                    lu->changed( i, j );
+                    changed = true;
+            }   }
+            return changed;
+        }
+
+        int nodes() { return m_nodes; }
+        const std::vector<double>& currents() { return m_curr; }
+
+        void clearBranches() { m_branches.clear(); m_dirty.assign( m_nodes, true ); }
+
+    private:
+        int m_nodes;
+        std::vector<Branch> m_branches;
+        std::vector<double> m_curr;
+        std::vector<bool>   m_dirty;
+};
+
+static const double gOn  = 1e2;  // Closed switch
+static const double gOff = 1e-8; // Open switch, same as Simulator gmin
+
+class Circuit
+{
+    public:
+        virtual ~Circuit(){}
+        virtual const char* name()=0;
+        virtual Net& build()=0;
+        virtual void step( int s )=0; // Update switches for step s
+};
+
+class HBridge : public Circuit // PWM H-bridge driving RL motor model, RC filters on both outputs
+{
+    public:
+        HBridge() : m_net( 60 ) {}
+
+        const char* name() { return "H-bridge PWM"; }
+
+        Net& build()
+        {
+            m_net.clearBranches();
+            int vcc = 0, outA = 30, outB = 31;
+            m_net.addBranch( vcc, -1, 1e3 );           // Supply
+            m_net.setCurrent( vcc, 12*1e3 );
+            for( int i=1; i<30; ++i )                  // Motor windings ladder
+            {
+                int a = (i == 1)  ? outA : i-1;
+                m_net.addBranch( a, i, 1/0.5 );
+                m_net.addBranch( i, -1, 1e-3 );        // Winding capacitance
+            }
+            m_net.addBranch( 29, outB, 1/0.5 );
+            for( int i=32; i<60; ++i )                 // Sense RC filters
+            {
+                int a = (i == 32) ? outA : (i == 46) ? outB : i-1;
+                m_net.addBranch( a, i, 1e-3 );
+                m_net.addBranch( i, -1, 1e-2 );
+            }
+            m_hiA = m_net.addBranch( vcc, outA, gOff );
+            m_loA = m_net.addBranch( outA, -1,  gOff );
+            m_hiB = m_net.addBranch( vcc, outB, gOff );
+            m_loB = m_net.addBranch( outB, -1,  gOff );
+            return m_net;
+        }
+        void step( int s )
+        {
+            bool on = (s%20) < 7;                      // 35% duty
+            bool fwd = (s/2000)%2;                     // Reverse sometimes
+            m_net.setAdmit( m_hiA, ( on &&  fwd) ? gOn : gOff );
+            m_net.setAdmit( m_loB, ( on &&  fwd) ? gOn : gOff );
+            m_net.setAdmit( m_hiB, ( on && !fwd) ? gOn : gOff );
+            m_net.setAdmit( m_loA, ( on && !fwd) ? gOn : gOff );
+        }
+
+    private:
+        Net m_net;
+        int m_hiA, m_loA, m_hiB, m_loB;
+};
+
+class Keypad : public Circuit // 4x4 keypad scanned by MCU pins, pullups on columns
+{
+    public:
+        Keypad() : m_net( 48 ) {}
+
+        const char* name() { return "Keypad scan"; }
+
+        Net& build()
+        {
+            m_net.clearBranches();
+            int vcc = 0;
+            m_net.addBranch( vcc, -1, 1e3 );
+            m_net.setCurrent( vcc, 5*1e3 );
+            for( int r=0; r<4; ++r ) m_rowPin[r] = m_net.addBranch( 1+r, -1, gOff ); // MCU row outputs
+            for( int c=0; c<4; ++c ) m_net.addBranch( vcc, 5+c, 1e-4 );             // Column pullups
+            for( int r=0; r<4; ++r )
+                for( int c=0; c<4; ++c )
+                    m_key[r*4+c] = m_net.addBranch( 1+r, 5+c, gOff );
+            for( int i=9; i<48; ++i )                  // Rest of the board: decoupling and leds
+            {
+                m_net.addBranch( i-1 < 9 ? vcc : i-1, i, 1e-2 );
+                m_net.addBranch( i, -1, 1e-3 );
+            }
+            for( int c=0; c<4; ++c ) m_net.addBranch( 5+c, 9+c*8, 1e-5 ); // Column inputs
+            return m_net;
+        }
+        void step( int s )
+        {
+            int row = (s/4)%4;                         // Drive one row low at a time
+            for( int r=0; r<4; ++r ) m_net.setAdmit( m_rowPin[r], (r == row) ? 1/40.0 : gOff );
+
+            int pressed = (s/1500)%16;                 // One key pressed at a time
+            for( int k=0; k<16; ++k ) m_net.setAdmit( m_key[k], (k == pressed) ? gOn : gOff );
+        }
+
+    private:
+        Net m_net;
+        int m_rowPin[4];
+        int m_key[16];
+};
+
+struct Result { double time; double factorTime; std::vector<double> volts; DenseLU* lu; };
+
+static Result run( Circuit* circ, bool lowRank, int steps )
+{
+    Net& net = circ->build();
+    int n = net.nodes();
+    DenseLU* lu = new DenseLU( n );
+    lu->setLowRank( lowRank );
+
+    Result res;
+    res.volts.reserve( steps*2 );
+    std::vector<double> x( n );
+
+    QElapsedTimer factorTimer;
+    qint64 factorTime = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for( int s=0; s<steps; ++s )
+    {
+        circ->step( s );
+        if( net.stamp( lu ) )        // Same as CircMatrix m_admitChanged
+        {
+            factorTimer.start();
+            lu->factor();
+            factorTime += factorTimer.nsecsElapsed();
+        }
+        x = net.currents();
+        lu->solve( x.data() );
+        res.volts.push_back( x[30%n] ); // Probe two nodes
+        res.volts.push_back( x[n-1] );
+    }
+    res.time = timer.nsecsElapsed()/1e6;
+    res.factorTime = factorTime/1e6;
+    res.lu = lu;
+    return res;
+}
+
+int main()
+{
+    SimdKernels::initKernels();
+
+    QTextStream out( stdout );
+    out << "Kernels: " << SimdKernels::name() << "\n\n";
+
+    const int steps = 20000;
+
+    HBridge hBridge;
+    Keypad  keypad;
+
+    for( Circuit* circ : std::vector<Circuit*>{ &hBridge, &keypad } )
+    {
+        Result full = run( circ, false, steps );
+        Result upd  = run( circ, true,  steps );
+
+        double maxDiff = 0;
+        for( unsigned i=0; i<full.volts.size(); ++i )
+        {
+            double diff = fabs( full.volts[i]-upd.volts[i] );
+            if( diff > maxDiff ) maxDiff = diff;
+        }
+        out << circ->name() << ": " << full.lu->size() << " nodes, " << steps << " steps\n";
+        out << "  Full refactor:   " << QString::number( full.time, 'f', 1 ) << " ms total, "
+            << QString::number( full.factorTime, 'f', 1 ) << " ms factoring, "
+            << full.lu->fullFactors() << " factorizations\n";
+        out << "  Low-rank update: " << QString::number( upd.time, 'f', 1 ) << " ms total, "
+            << QString::number( upd.factorTime, 'f', 1 ) << " ms factoring, "
+            << upd.lu->fullFactors()    << " full, "
+            << upd.lu->partialFactors() << " partial, "
+            << upd.lu->rankUpdates()    << " rank-k, "
+            << upd.lu->restores()       << " reused\n";
+        out << "  Factoring speedup: " << QString::number( full.factorTime/upd.factorTime, 'f', 2 )
+            << "x   Max voltage difference: " << QString::number( maxDiff, 'e', 2 ) << "\n\n";
+
+        delete full.lu;
+        delete upd.lu;
+    }
+    return 0;
+}
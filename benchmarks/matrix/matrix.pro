@@ -0,0 +1,19 @@
+TEMPLATE = app
+TARGET = matrix_bench
+
+QT = core
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG *= c++11
+
+INCLUDEPATH += $$PWD/../../src/simulator
+
+SOURCES = $$PWD/main.cpp \
+          $$PWD/../../src/simulator/denselu.cpp \
+          $$PWD/../../src/simulator/simdkernels.cpp
+
+HEADERS = $$PWD/../../src/simulator/denselu.h \
+          $$PWD/../../src/simulator/simdkernels.h
+
+QMAKE_CXXFLAGS += -O2
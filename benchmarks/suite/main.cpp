@@ -0,0 +1,240 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+// Simulation benchmark suite:
+// Runs the reference circuits in benchmarks/circuits with simulide --headless,
+// for a fixed simulated time at max speed, and writes the results as JSON:
+// events/s, matrix factorizations/s, simulated ps per wall second and peak memory.
+//
+// simbench [--simulide path] [--circuits dir] [--runs N] [--out results.json] [--only name]
+// simbench --compare baseline.json results.json [--threshold 10]
+//
+// Compare flags a regression if speed (ps/s) drops or peak memory grows more than
+// threshold % from the baseline, other values are shown for reference.
+// Returns 1 if there are regressions or errors.
+//
+// No baseline is checked in: timings depend on the machine. Generate baseline.json
+// with a reference build on the same machine, see benchmarks/circuits/suite.txt
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QProcess>
+#include <QRegExp>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <algorithm>
+#include <vector>
+
+struct bench_t
+{
+    QString name;
+    QString file;
+    QString time;
+};
+
+static QTextStream out( stdout );
+
+static void usage()
+{
+    out << "Usage: simbench [--simulide path] [--circuits dir] [--runs N] [--out results.json] [--only name]\n"
+        << "       simbench --compare baseline.json results.json [--threshold 10]\n"
+        << "  --simulide  SimulIDE executable (default: simulide in PATH)\n"
+        << "  --circuits  Directory with suite.txt and circuits (default: ../circuits from this program)\n"
+        << "  --runs      Runs of each circuit, median wall time is used (default 3)\n"
+        << "  --out       Results file (default stdout)\n"
+        << "  --only      Run only this benchmark\n"
+        << "  --compare   Compare results against a baseline\n"
+        << "  --threshold Regression threshold in % (default 10)\n";
+}
+
+static std::vector<bench_t> readSuite( QString dir ) // Lines: name file time
+{
+    std::vector<bench_t> suite;
+    QFile file( dir+"/suite.txt" );
+    if( !file.open( QFile::ReadOnly | QFile::Text ) ) return suite;
+
+    QTextStream in( &file );
+    while( !in.atEnd() )
+    {
+        QString line = in.readLine().trimmed();
+        if( line.isEmpty() || line.startsWith("#") ) continue;
+        QStringList words = line.split( QRegExp("\\s+") );
+        if( words.size() < 3 ) continue;
+        suite.push_back( { words.at(0), dir+"/"+words.at(1), words.at(2) } );
+    }
+    return suite;
+}
+
+static QJsonObject runOnce( QString simulide, const bench_t& bench, bool* ok )
+{
+    QProcess process;
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    if( !env.contains("QT_QPA_PLATFORM") ) env.insert("QT_QPA_PLATFORM", "offscreen");
+    process.setProcessEnvironment( env );
+    process.setProcessChannelMode( QProcess::SeparateChannels ); // Simulator log goes to stderr
+
+    QStringList args = { "--headless", bench.file, "--time", bench.time, "--max-speed", "--json" };
+    process.start( simulide, args );
+    process.waitForFinished( -1 );
+
+    QByteArray output = process.readAllStandardOutput();
+    int start = output.indexOf('{');
+    QJsonObject result;
+    if( start >= 0 ) result = QJsonDocument::fromJson( output.mid( start ) ).object();
+
+    *ok = !result.isEmpty() && process.exitStatus() == QProcess::NormalExit;
+    if( !*ok ) result["error"] = "simulide failed, exit code "+QString::number( process.exitCode() );
+    return result;
+}
+
+static int runSuite( QString simulide, QString circDir, QString outFile, QString only, int runs )
+{
+    std::vector<bench_t> suite = readSuite( circDir );
+    if( suite.empty() )
+    {
+        out << "Error: no benchmarks in " << circDir << "/suite.txt\n";
+        return 1;
+    }
+    QJsonObject benchmarks;
+    int errors = 0;
+    for( const bench_t& bench : suite )
+    {
+        if( !only.isEmpty() && bench.name != only ) continue;
+        QTextStream( stderr ) << bench.name << "... ";
+
+        std::vector<QJsonObject> results;
+        bool ok = true;
+        for( int r=0; r<runs && ok; ++r ) results.push_back( runOnce( simulide, bench, &ok ) );
+
+        QJsonObject result;
+        if( ok ){
+            std::sort( results.begin(), results.end(), []( const QJsonObject& a, const QJsonObject& b )
+                       { return a["wall_s"].toDouble() < b["wall_s"].toDouble(); } );
+            result = results.at( results.size()/2 );
+        }
+        else result = results.back();
+
+        result.remove("circuit");
+        result["sim_time"] = bench.time;
+        benchmarks[bench.name] = result;
+
+        QString error = result["error"].toString();
+        if( !error.isEmpty() ) errors++;
+        QTextStream( stderr ) << ( error.isEmpty() ? QString::number( result["ps_per_s"].toDouble(), 'g', 4 )+" ps/s" : error ) << "\n";
+    }
+    QJsonObject root;
+    root["benchmarks"] = benchmarks;
+    QByteArray json = QJsonDocument( root ).toJson();
+
+    if( outFile.isEmpty() ) out << json;
+    else{
+        QFile file( outFile );
+        if( !file.open( QFile::WriteOnly ) )
+        {
+            out << "Error: cannot write " << outFile << "\n";
+            return 1;
+        }
+        file.write( json );
+        file.close();
+    }
+    return errors ? 1 : 0;
+}
+
+static QJsonObject readResults( QString fileName )
+{
+    QFile file( fileName );
+    if( !file.open( QFile::ReadOnly ) ) return QJsonObject();
+    return QJsonDocument::fromJson( file.readAll() ).object()["benchmarks"].toObject();
+}
+
+static int compare( QString baseFile, QString newFile, double threshold )
+{
+    QJsonObject base = readResults( baseFile );
+    QJsonObject next = readResults( newFile );
+    if( base.isEmpty() || next.isEmpty() )
+    {
+        out << "Error: cannot read " << ( base.isEmpty() ? baseFile : newFile ) << "\n";
+        if( base.isEmpty() ) out << "Generate a baseline with a reference build: simbench --simulide path --out " << baseFile << "\n";
+        return 1;
+    }
+    struct metric_t { const char* key; const char* label; bool higherIsBetter; bool check; };
+    const metric_t metrics[] = {
+        { "ps_per_s",      "ps/s",       true,  true  },
+        { "peak_rss_mb",   "peak MB",    false, true  },
+        { "events_per_s",  "events/s",   true,  false },
+        { "factors_per_s", "factors/s",  true,  false },
+    };
+    int regressions = 0;
+    for( QString name : base.keys() )
+    {
+        QJsonObject b = base[name].toObject();
+        if( !next.contains( name ) ) { out << name << ": MISSING\n"; regressions++; continue; }
+
+        QJsonObject n = next[name].toObject();
+        QString error = n["error"].toString();
+        if( !error.isEmpty() ) { out << name << ": ERROR " << error << "\n"; regressions++; continue; }
+
+        out << name << ":\n";
+        for( const metric_t& m : metrics )
+        {
+            double bv = b[m.key].toDouble();
+            double nv = n[m.key].toDouble();
+            if( bv <= 0 ) continue;
+            double change = 100*(nv-bv)/bv;
+            bool worse = m.higherIsBetter ? (change < -threshold) : (change > threshold);
+            bool flag = m.check && worse;
+            if( flag ) regressions++;
+
+            out << "  " << QString( m.label ).leftJustified( 10 )
+                << QString::number( bv, 'g', 4 ).rightJustified( 11 ) << " -> "
+                << QString::number( nv, 'g', 4 ).rightJustified( 11 )
+                << QString( "  %1%2 %" ).arg( change >= 0 ? "+" : "" ).arg( change, 0, 'f', 1 )
+                << ( flag ? "  REGRESSION" : "" ) << "\n";
+    }   }
+    out << "\n" << regressions << " regressions (threshold " << threshold << " %)\n";
+    return regressions ? 1 : 0;
+}
+
+int main( int argc, char* argv[] )
+{
+    QCoreApplication app( argc, argv );
+    QStringList args = app.arguments();
+
+    QString simulide = "simulide";
+    QString circDir  = QDir( app.applicationDirPath()+"/../circuits" ).absolutePath();
+    QString outFile;
+    QString only;
+    int runs = 3;
+    double threshold = 10;
+    QStringList compareFiles;
+
+    for( int i=1; i<args.size(); ++i )
+    {
+        QString arg = args.at(i);
+        bool next = i+1 < args.size();
+        if     ( arg == "--simulide"  && next ) simulide = args.at( ++i );
+        else if( arg == "--circuits"  && next ) circDir  = QFileInfo( args.at( ++i ) ).absoluteFilePath();
+        else if( arg == "--runs"      && next ) runs     = args.at( ++i ).toInt();
+        else if( arg == "--out"       && next ) outFile  = args.at( ++i );
+        else if( arg == "--only"      && next ) only     = args.at( ++i );
+        else if( arg == "--threshold" && next ) threshold = args.at( ++i ).toDouble();
+        else if( arg == "--compare" && i+2 < args.size() )
+        {
+            compareFiles << args.at( i+1 ) << args.at( i+2 );
+            i += 2;
+        }
+        else{
+            out << "Error: unknown argument: " << arg << "\n";
+            usage();
+            return 1;
+    }   }
+    if( runs < 1 ) runs = 1;
+    if( !compareFiles.isEmpty() ) return compare( compareFiles.at(0), compareFiles.at(1), threshold );
+
+    return runSuite( simulide, circDir, outFile, only, runs );
+}
@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = simbench
+
+QT = core
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG *= c++11
+
+SOURCES = $$PWD/main.cpp
+
+QMAKE_CXXFLAGS += -O2
@@ -137,14 +137,11 @@ void Diode::updateStep()
         m_warning = false;
         m_crashed = false;
     }
-    if( m_changed ) voltChanged(); // m_changed cleared at eDiode::voltChanged
+    if( m_changed ) voltChanged(); // m_changed cleared at eDiode::newVoltPN
 }
 
-void Diode::voltChanged()
+void Diode::nlConverged()
 {
-    eDiode::voltChanged();
-    if( !m_converged ) return;
-
     if( !m_linkedComp.isEmpty() )
     {
         double current = m_resistor->current();
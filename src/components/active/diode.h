@@ -20,8 +20,6 @@ class Diode : public LinkerComponent, public eDiode
  static Component* construct( QString type, QString id );
  static LibraryItem* libraryItem();
 
-        virtual void voltChanged() override;
-
         virtual bool setPropStr( QString prop, QString val ) override;
 
         virtual void initialize() override;
@@ -33,6 +31,9 @@ class Diode : public LinkerComponent, public eDiode
 
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget ) override;
 
+    protected:
+        virtual void nlConverged() override;
+
     private:
         bool m_isZener;
 
@@ -30,6 +30,8 @@ class BinCounter : public LogicComponent
         virtual void voltChanged() override;
         virtual void runEvent() override { IoComponent::runOutputs(); }
 
+        virtual bool saveState( QDataStream& out ) override { LogicComponent::saveState( out ); return false; } // Counter not saved
+
         int maxVal() { return m_TopValue; }
         void setMaxVal( int v ) { m_TopValue = v; }
 
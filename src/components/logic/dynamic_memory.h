@@ -25,6 +25,8 @@ class DynamicMemory : public LogicComponent, public MemData
         virtual void voltChanged() override;
         virtual void runEvent() override;
 
+        virtual bool saveState( QDataStream& out ) override { LogicComponent::saveState( out ); return false; } // Memory data not saved
+
         int rowAddrBits() { return m_rowAddrBits; }
         int colAddrBits() { return m_colAddrBits; }
         void setRowAddrBits( int bits );
@@ -3,6 +3,8 @@
  *                                                                         *
  ***( see copyright.txt file at root folder )*******************************/
 
+#include <QDataStream>
+
 #include "logiccomponent.h"
 #include "circuitwidget.h"
 #include "simulator.h"
@@ -49,6 +51,40 @@ std::vector<Pin*> LogicComponent::getPins()
     return pins;
 }
 
+bool LogicComponent::saveState( QDataStream& out ) // Subclasses with more internal state return false
+{
+    out << (quint32)m_outValue << (quint32)m_nextOutVal << m_outEnable << m_clock << (qint32)m_clkState;
+
+    std::queue<uint> outQueue = m_outQueue;  // Scheduled output changes
+    out << (quint32)outQueue.size();
+    while( !outQueue.empty() ) { out << (quint32)outQueue.front(); outQueue.pop(); }
+
+    std::queue<uint64_t> timeQueue = m_timeQueue;
+    out << (quint32)timeQueue.size();
+    while( !timeQueue.empty() ) { out << (quint64)timeQueue.front(); timeQueue.pop(); }
+    return true;
+}
+
+void LogicComponent::loadState( QDataStream& in )
+{
+    quint32 outValue, nextOutVal, size;
+    qint32 clkState;
+    in >> outValue >> nextOutVal >> m_outEnable >> m_clock >> clkState;
+    m_outValue   = outValue;
+    m_nextOutVal = nextOutVal;
+    m_clkState   = (clkState_t)clkState;
+
+    m_outQueue = std::queue<uint>();
+    in >> size;
+    for( quint32 i=0; i<size; ++i ) { quint32 value; in >> value; m_outQueue.push( value ); }
+
+    m_timeQueue = std::queue<uint64_t>();
+    in >> size;
+    for( quint32 i=0; i<size; ++i ) { quint64 time; in >> time; m_timeQueue.push( time ); }
+
+    if( !m_outQueue.empty() ) m_eElement = this;
+}
+
 void LogicComponent::remove()
 {
     if( m_oePin ) m_oePin->removeConnector();
@@ -11,6 +11,7 @@
 #include "serialmon.h"
 #include "itemlibrary.h"
 #include "simulator.h"
+#include "stimulus.h"
 #include "circuit.h"
 #include "usarttx.h"
 #include "usartrx.h"
@@ -117,6 +118,7 @@ void SerialPort::stamp()
 {
     m_serData.clear();
     m_uartData.clear();
+    m_hostData.clear();
     m_sender->enable( true );
     m_receiver->enable( true );
     m_sending = false;
@@ -134,11 +136,23 @@ void SerialPort::updateStep()
     }
     else m_receiving = false;
 
+    if( m_hostData.size() ) // Data from host takes effect now
+    {
+        Stimulus::self()->addInput( this, m_hostData );
+        m_uartData += m_hostData;
+        m_hostData.clear();
+    }
     if( m_uartData.size() && !m_sending ) Simulator::self()->addEvent( 1, this );
 
     update();
 }
 
+void SerialPort::replayInput( const QByteArray& data )
+{
+    m_uartData += data;
+    if( !m_sending && !eventTime ) Simulator::self()->addEvent( 1, this );
+}
+
 void SerialPort::runEvent()
 {
     if( m_uartData.isEmpty() ) return;
@@ -181,7 +195,9 @@ void SerialPort::close()
 
 void SerialPort::readData()
 {
-    m_uartData += m_serial->readAll();
+    QByteArray data = m_serial->readAll();
+    if( Stimulus::self()->replaying() ) return; // Replaying: data comes from Stimulus log
+    m_hostData += data;
 }
 
 void SerialPort::setflip()
@@ -28,6 +28,7 @@ class SerialPort : public Component, public UsartModule, public eElement
         virtual void stamp() override;
         virtual void updateStep() override;
         virtual void runEvent() override;
+        virtual void replayInput( const QByteArray& data ) override;
 
         bool autoOpen() { return m_autoOpen; }
         void setAutoOpen( bool a ) { m_autoOpen = a; }
@@ -81,6 +82,7 @@ class SerialPort : public Component, public UsartModule, public eElement
 
         QByteArray m_serData;
         QByteArray m_uartData;
+        QByteArray m_hostData; // Received from host, sent to circuit at next updateStep()
 
         QString m_portName;
 
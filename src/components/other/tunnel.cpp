@@ -21,8 +21,6 @@
 
 #define tr(str) simulideTr("Tunnel",str)
 
-QHash<QString, QList<Tunnel*>*> Tunnel::m_tunnels;
-
 Component* Tunnel::construct( QString type, QString id )
 { return new Tunnel( type, id ); }
 
@@ -44,6 +42,7 @@ Tunnel::Tunnel( QString type, QString id )
     m_packed  = false;
     m_show    = false;
     m_name = "";
+    m_tunnels = Circuit::self()->tunnelMap(); // Tunnels of this Circuit only
 
     m_pin.resize( 1 );
     m_pin[0] = new Pin( 0, QPoint(0,0), id+"-pin", 0, this);
@@ -92,7 +91,7 @@ void Tunnel::registerEnode( eNode* enode, int n ) // called by m_pin[0]
 {
     if( m_blocked ) return;
 
-    QList<Tunnel*>* list = m_tunnels.value( m_name );
+    QList<Tunnel*>* list = m_tunnels->value( m_name );
     if( !list ) return;
 
     m_blocked = true;
@@ -121,16 +120,16 @@ void Tunnel::setGroupName( QString name, bool single )
     else  m_size = snapToGrid( m_pin[0]->labelSizeX()+4 );
     setRotated( m_rotated );
 
-    if( m_tunnels.contains( name ) ) // There is already tunnel with this name
+    if( m_tunnels->contains( name ) ) // There is already tunnel with this name
     {
-        QList<Tunnel*>* list = m_tunnels.value( name );
+        QList<Tunnel*>* list = m_tunnels->value( name );
         if( !list->contains( this ) ) list->append( this );
     }
     else   // name doesn't exist: Create a new List for this name
     {
         QList<Tunnel*>* list = new QList<Tunnel*>();
         list->append( this );
-        m_tunnels[name] = list;
+        (*m_tunnels)[name] = list;
     }
     if( single ) Circuit::self()->update();
     if( m_propDialog ) m_propDialog->updtValues();
@@ -178,13 +177,13 @@ void Tunnel::removeTunnel()
 {
     if( m_name.isEmpty() ) return;
 
-    QList<Tunnel*>* list = m_tunnels.value( m_name );
+    QList<Tunnel*>* list = m_tunnels->value( m_name );
     if( !list ) return;
 
     list->removeAll( this );
     if( !list->isEmpty() ) return;
 
-    m_tunnels.remove( m_name );
+    m_tunnels->remove( m_name );
     delete list;
 }
 
@@ -222,7 +221,7 @@ void Tunnel::renameGroup()
                                          m_name, &ok );
     if( ok && !text.isEmpty() )
     {
-        QList<Tunnel*>* list = m_tunnels.value( m_name );
+        QList<Tunnel*>* list = m_tunnels->value( m_name );
         if( !list ) return;
         QVector<Tunnel*> tunnels = list->toVector();
         for( Tunnel* tunnel: tunnels ) tunnel->setGroupName( text, false );
@@ -233,7 +232,7 @@ void Tunnel::renameGroup()
 
 void Tunnel::showGroup()
 {
-    for( QList<Tunnel*>* list : m_tunnels.values() )  // Hide other groups
+    for( QList<Tunnel*>* list : m_tunnels->values() )  // Hide other groups
     {
         if( !list ) continue;
         for( Tunnel* tunnel: *list ) tunnel->m_show = false;
@@ -243,7 +242,7 @@ void Tunnel::showGroup()
 
 void Tunnel::showHide( bool show )
 {
-    QList<Tunnel*>* list = m_tunnels.value( m_name );
+    QList<Tunnel*>* list = m_tunnels->value( m_name );
     if( !list ) return;
     for( Tunnel* tunnel: *list ) tunnel->m_show = show;
     Circuit::self()->update();
@@ -265,7 +264,7 @@ void Tunnel::paint( QPainter* p, const QStyleOptionGraphicsItem *option, QWidget
 {
     if( m_hidden || m_packed ) return;
 
-    if( m_tunnels.contains( m_name ) )
+    if( m_tunnels->contains( m_name ) )
     {
         if( m_pin[0]->isBus() ) m_color = QColor( 100, 220, 100 );
         else                    m_color = QColor( 255, 255, 250 );
@@ -302,7 +301,7 @@ void Tunnel::paint( QPainter* p, const QStyleOptionGraphicsItem *option, QWidget
 
 eNode* Tunnel::getEnode( QString n ) // Static
 {
-    QList<Tunnel*>* list = m_tunnels.value( n );
+    QList<Tunnel*>* list = Circuit::self()->tunnelMap()->value( n );
     if( !list ) return NULL;
     Tunnel* tunnel= list->first();
     if( tunnel ) return tunnel->getPin()->getEnode();
@@ -311,5 +310,5 @@ eNode* Tunnel::getEnode( QString n ) // Static
 
 void Tunnel::clearTunnels() // Static
 {
-    m_tunnels.clear();
+    Circuit::self()->tunnelMap()->clear();
 }
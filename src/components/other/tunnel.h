@@ -73,8 +73,7 @@ class Tunnel : public Component
         bool m_blocked;
         bool m_packed;
 
-
- static QHash<QString, QList<Tunnel*>*> m_tunnels;
+        QHash<QString, QList<Tunnel*>*>* m_tunnels; // Circuit tunnel map
 };
 
 #endif
@@ -26,6 +26,9 @@ class Hd44780 : public Hd44780_Base, public eElement
         virtual void updateStep() override;
         virtual void voltChanged() override;
 
+        virtual bool saveState( QDataStream& out ) override { saveDisplay( out ); return true; }
+        virtual void loadState( QDataStream& in ) override { loadDisplay( in ); }
+
         void showPins( bool show );
 
     private:
@@ -4,6 +4,7 @@
  ***( see copyright.txt file at root folder )*******************************/
 
 #include <QPainter>
+#include <QDataStream>
 
 #include "connector.h"
 #include "simulator.h"
@@ -172,6 +173,29 @@ void Hd44780_Base::setCGaddr( int addr )
     m_writeDDRAM = false;
 }
 
+void Hd44780_Base::saveDisplay( QDataStream& out )
+{
+    for( int i=0; i<80; ++i ) out << (qint32)m_DDram[i];
+    for( int i=0; i<64; ++i ) out << (qint32)m_CGram[i];
+
+    int regs[13] = { m_cursPos, m_shiftPos, m_direction, m_shiftDisp, m_dispOn, m_cursorOn, m_cursorBlink
+                   , m_dataLength, m_lineLength, m_DDaddr, m_CGaddr, m_nibble, m_input };
+    for( int reg : regs ) out << (qint32)reg;
+    out << m_lastClock << m_writeDDRAM << m_blinking;
+}
+
+void Hd44780_Base::loadDisplay( QDataStream& in )
+{
+    qint32 val;
+    for( int i=0; i<80; ++i ) { in >> val; m_DDram[i] = val; }
+    for( int i=0; i<64; ++i ) { in >> val; m_CGram[i] = val; }
+
+    int* regs[13] = { &m_cursPos, &m_shiftPos, &m_direction, &m_shiftDisp, &m_dispOn, &m_cursorOn, &m_cursorBlink
+                    , &m_dataLength, &m_lineLength, &m_DDaddr, &m_CGaddr, &m_nibble, &m_input };
+    for( int* reg : regs ) { in >> val; *reg = val; }
+    in >> m_lastClock >> m_writeDDRAM >> m_blinking;
+}
+
 void Hd44780_Base::clearDDRAM()
 {
     for(int i=0; i<80; i++) m_DDram[i] = 32;
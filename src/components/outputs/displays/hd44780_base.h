@@ -29,6 +29,9 @@ class Hd44780_Base : public Component
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* o, QWidget* w );
         
     protected:
+        void saveDisplay( QDataStream& out ); // Display Ram and registers for Simulator checkpoints
+        void loadDisplay( QDataStream& in );
+
         void clearDDRAM();
         void clearLcd();
         void writeData( int data );
@@ -4,6 +4,7 @@
  ***( see copyright.txt file at root folder )*******************************/
 
 #include <QPainter>
+#include <string.h>
 
 #include "ili9341.h"
 #include "itemlibrary.h"
@@ -64,6 +65,7 @@ Ili9341::Ili9341( QString type, QString id )
 
     m_clkPin = &m_pinSck;
 
+    m_snapshot = true;
     Simulator::self()->addToUpdateList( this );
     
     setLabelPos(-32,-180, 0);
@@ -85,7 +87,8 @@ void Ili9341::initialize()
 {
     clearDDRAM();
     reset();
-    Ili9341::updateStep();
+    Ili9341::takeSnapshot();
+    update();
 }
 
 void Ili9341::updateStep()
@@ -93,6 +96,12 @@ void Ili9341::updateStep()
     update();
 }
 
+void Ili9341::takeSnapshot()
+{
+    memcpy( m_frontRam, m_aDispRam, sizeof(m_aDispRam) );
+    m_frontOn = m_dispOn;
+}
+
 void Ili9341::voltChanged()
 {
     bool ret = false;
@@ -406,7 +415,7 @@ void Ili9341::paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidge
     p->setBrush( QColor(50, 70, 100) );
     p->drawRoundedRect( m_area,2,2 );
 
-    if( !m_dispOn ) p->fillRect(-120,-162, 240, 320, Qt::black ); // Display Off
+    if( !m_frontOn ) p->fillRect(-120,-162, 240, 320, Qt::black ); // Display Off
     else{
         QImage img( 240*2, 320*2, QImage::Format_RGB32 );
         QPainter painter;
@@ -418,7 +427,7 @@ void Ili9341::paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidge
             int y = row*2;
             for( int col=0; col<=239; col++ )
             {
-                uint pixel = m_aDispRam[col][row];
+                uint pixel = m_frontRam[col][row];
                 painter.fillRect( col*2, y, 2, 2, QColor(pixel).rgb() );
         }   }
 
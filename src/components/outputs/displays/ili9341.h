@@ -25,6 +25,7 @@ class Ili9341 : public Component, public eClockedDevice
         virtual void initialize() override;
         virtual void voltChanged() override;
         virtual void updateStep() override;
+        virtual void takeSnapshot() override;
         
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget ) override;
 
@@ -38,6 +39,7 @@ class Ili9341 : public Component, public eClockedDevice
 
         unsigned char m_rxReg;     // Received value
         unsigned int m_aDispRam[240][320]; // DDRAM
+        unsigned int m_frontRam[240][320]; // DDRAM at last frame, used in paint()
 
         int m_inBit;        //How many bits have we read since last byte
         int m_inByte;
@@ -68,6 +70,7 @@ class Ili9341 : public Component, public eClockedDevice
         int m_readBytes;
 
         bool m_dispOn;
+        bool m_frontOn;
         //bool m_dispFull;
         bool m_dispInv;
 
@@ -5,6 +5,7 @@
 
 #include <QPainter>
 #include <math.h>
+#include <string.h>
 
 #include "ks0108.h"
 #include "itemlibrary.h"
@@ -68,6 +69,7 @@ Ks0108::Ks0108( QString type, QString id )
     m_pin[12] = &m_pinRW;
     m_pin[13] = &m_pinDC;
 
+    m_snapshot = true;
     Simulator::self()->addToUpdateList( this );
     
     setLabelPos( -32,-68, 0);
@@ -88,7 +90,8 @@ void Ks0108::initialize()
 {
     clearDDRAM();
     reset() ;
-    updateStep();
+    takeSnapshot();
+    update();
 }
 
 void Ks0108::stamp()
@@ -102,6 +105,12 @@ void Ks0108::updateStep()
     update();
 }
 
+void Ks0108::takeSnapshot()
+{
+    memcpy( m_frontRam, m_aDispRam, sizeof(m_aDispRam) );
+    m_frontOn = m_dispOn;
+}
+
 void Ks0108::voltChanged()                 // Called when En Pin changes 
 {
     if( m_pinRst.getVoltage()<2.5 ) reset();            // Reset Pin is Low
@@ -249,7 +258,7 @@ void Ks0108::paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget
     p->setBrush( QColor(200, 220, 180) );
     p->drawRoundedRect( -70, -48, 140, 76, 8, 8 );
 
-    if( !m_dispOn ) p->fillRect(-64,-42, 128, 64, QColor(200,215,180) );
+    if( !m_frontOn ) p->fillRect(-64,-42, 128, 64, QColor(200,215,180) );
     else{
         QImage img( 128*3, 64*3, QImage::Format_RGB32 );
         QPainter painter;
@@ -260,7 +269,7 @@ void Ks0108::paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget
             for( int col=0; col<128; col++ )
             {
                 int x = col*3;
-                char abyte = m_aDispRam[row][col];
+                char abyte = m_frontRam[row][col];
 
                 for( int bit=0; bit<8; bit++ )
                 {
@@ -24,6 +24,7 @@ class Ks0108 : public Component, public eElement
         virtual void initialize() override;
         virtual void stamp() override;
         virtual void updateStep() override;
+        virtual void takeSnapshot() override;
         virtual void voltChanged() override;
 
         void setCsActLow( bool low ) { m_csActLow = low; }
@@ -46,6 +47,7 @@ class Ks0108 : public Component, public eElement
         void reset();
 
         unsigned char m_aDispRam[8][128];                 //128x64 DDRAM
+        unsigned char m_frontRam[8][128];                 // DDRAM at last frame, used in paint()
         
         int m_input;
         int m_addrX1;                                   // X RAM address
@@ -58,6 +60,7 @@ class Ks0108 : public Component, public eElement
         bool m_Cs1;
         bool m_Cs2;
         bool m_dispOn;
+        bool m_frontOn;
         bool m_lastScl;
         bool m_reset;
         bool m_Write;
@@ -14,6 +14,7 @@
 // Copyright: See COPYING file that comes with this distribution
 
 #include <QPainter>
+#include <string.h>
 
 #include "itemlibrary.h"
 #include "connector.h"
@@ -59,6 +60,7 @@ Pcd8544::Pcd8544( QString type, QString id )
     m_pSi.setLabelText( "DIN");
     m_pScl.setLabelText("CLK");
 
+    m_snapshot = true;
     Simulator::self()->addToUpdateList( this );
     
     setLabelPos( -32,-66, 0);
@@ -79,7 +81,8 @@ void Pcd8544::initialize()
 {
     clearDDRAM();
     reset() ;
-    Pcd8544::updateStep();
+    Pcd8544::takeSnapshot();
+    update();
 }
 
 void Pcd8544::updateStep()
@@ -87,6 +90,14 @@ void Pcd8544::updateStep()
     update();
 }
 
+void Pcd8544::takeSnapshot()
+{
+    memcpy( m_frontRam, m_aDispRam, sizeof(m_aDispRam) );
+    m_frontPD = m_bPD;
+    m_frontD  = m_bD;
+    m_frontE  = m_bE;
+}
+
 void Pcd8544::voltChanged()               // Called when Scl, Rst or Cs Pin changes
 {
     if( m_pRst.getVoltage()<0.3 )            // Reset Pin is Low
@@ -205,9 +216,9 @@ void Pcd8544::paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidge
     p->setBrush( QColor(200, 220, 180) );
     p->drawRoundedRect( -48, -48, 96, 60, 8, 8 );
 
-    if     ( m_bPD )          p->fillRect(-42,-42, 84, 48, QColor(200,215,180) ); // Power-Down mode
-    else if( !m_bD && !m_bE ) p->fillRect(-42,-42, 84, 48, QColor(200,215,180) ); // Blank Display mode, blank the visuals
-    else if( !m_bD &&  m_bE ) p->fillRect(-42,-42, 84, 48, Qt::black );           // All segments on
+    if     ( m_frontPD )              p->fillRect(-42,-42, 84, 48, QColor(200,215,180) ); // Power-Down mode
+    else if( !m_frontD && !m_frontE ) p->fillRect(-42,-42, 84, 48, QColor(200,215,180) ); // Blank Display mode, blank the visuals
+    else if( !m_frontD &&  m_frontE ) p->fillRect(-42,-42, 84, 48, Qt::black );           // All segments on
     else{
         QImage img( 84*3, 48*3, QImage::Format_RGB32 );
         QPainter painter;
@@ -218,8 +229,8 @@ void Pcd8544::paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidge
             for( int col=0; col<84; col++ )
             {
                 int x = col*3;
-                char abyte = m_aDispRam[row][col];
-                if( m_bD && m_bE ) abyte = ~abyte; // Display Inverted
+                char abyte = m_frontRam[row][col];
+                if( m_frontD && m_frontE ) abyte = ~abyte; // Display Inverted
 
                 for( int bit=0; bit<8; bit++ )
                 {
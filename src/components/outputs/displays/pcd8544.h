@@ -35,6 +35,7 @@ class Pcd8544 : public Component, public eElement
         virtual void initialize() override;
         virtual void voltChanged() override;
         virtual void updateStep() override;
+        virtual void takeSnapshot() override;
         
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget ) override;
 
@@ -45,6 +46,7 @@ class Pcd8544 : public Component, public eElement
         void clearDDRAM();
 
         unsigned char m_aDispRam[6][84];                   //84x48 DDRAM
+        unsigned char m_frontRam[6][84];                   // DDRAM at last frame, used in paint()
 
         //Controller state
         bool m_bPD;
@@ -52,6 +54,9 @@ class Pcd8544 : public Component, public eElement
         bool m_bH;
         bool m_bD;
         bool m_bE;
+        bool m_frontPD;                                 // Controller state at last frame
+        bool m_frontD;
+        bool m_frontE;
         bool m_lastScl;
         int m_addrX;                                    // X RAM address
         int m_addrY;                                    // Y RAM address
@@ -4,6 +4,7 @@
  ***( see copyright.txt file at root folder )*******************************/
 
 #include <QPainter>
+#include <string.h>
 
 #include "ssd1306.h"
 #include "itemlibrary.h"
@@ -73,6 +74,7 @@ Ssd1306::Ssd1306( QString type, QString id )
 
     m_dColor = White;
     m_rotate = true;
+    m_snapshot = true;
     
     Simulator::self()->addToUpdateList( this );
     
@@ -116,7 +118,8 @@ void Ssd1306::initialize()
 
     clearDDRAM();
     reset() ;
-    Ssd1306::updateStep();
+    Ssd1306::takeSnapshot();
+    update();
 }
 
 void Ssd1306::stamp()
@@ -155,7 +158,9 @@ void Ssd1306::reset()
     m_scrollV  = false;
 }
 
-void Ssd1306::updateStep()
+void Ssd1306::updateStep() { update(); }
+
+void Ssd1306::takeSnapshot() // Simulation stopped: scroll and copy DDRAM
 {
     if( m_scroll )
     {
@@ -180,7 +185,12 @@ void Ssd1306::updateStep()
                         if( col == 127 ) m_aDispRam[col][row] = start;
     }   }   }   }   }
 
-    update();
+    memcpy( m_frontRam, m_aDispRam, sizeof(m_aDispRam) );
+    m_frontOn      = m_dispOn;
+    m_frontFull    = m_dispFull;
+    m_frontInv     = m_dispInv;
+    m_frontScanInv = m_scanInv;
+    m_frontMr      = m_mr;
 }
 
 void Ssd1306::startWrite()
@@ -438,21 +448,21 @@ void Ssd1306::paint( QPainter* p, const QStyleOptionGraphicsItem*, QWidget* )
     p->setBrush( QColor( 50, 70, 100 ) );
     p->drawRoundedRect( m_area, 2, 2 );
 
-    if( m_dispFull ) p->fillRect(-64,-m_height/2-10, m_width, m_height, m_foreground );
+    if( m_frontFull ) p->fillRect(-64,-m_height/2-10, m_width, m_height, m_foreground );
     else{
         QImage img( m_width*3, m_height*3, QImage::Format_RGB32 );
         QPainter painter;
         painter.begin( &img );
         painter.fillRect( 0, 0, m_width*3, m_height*3, Qt::black );
 
-        bool scanInv = m_rotate ? !m_scanInv : m_scanInv;
+        bool scanInv = m_rotate ? !m_frontScanInv : m_frontScanInv;
 
-        if( m_dispOn  ){
+        if( m_frontOn ){
             for( int row=0; row<8; row++ ){
                 for( int col=0; col<128; col++ )
                 {
-                    uint8_t abyte = m_aDispRam[col][row];
-                    if( m_dispInv ) abyte = ~abyte;      // Display Inverted
+                    uint8_t abyte = m_frontRam[col][row];
+                    if( m_frontInv ) abyte = ~abyte;      // Display Inverted
 
                     int x = col*3;
                     if( scanInv ) x = 127*3-x;
@@ -462,7 +472,7 @@ void Ssd1306::paint( QPainter* p, const QStyleOptionGraphicsItem*, QWidget* )
                         if( abyte & 1 ){
                             int y = row*8+bit;
                             if( y >= m_height ) continue;
-                            if( y > m_mr ) continue;
+                            if( y > m_frontMr ) continue;
                             if( scanInv ) y = 63-y;
                             painter.fillRect( x, y*3, 3, 3, m_foreground );
                        }
@@ -45,6 +45,7 @@ class Ssd1306 : public Component, public TwiModule
         virtual void initialize() override;
         virtual void stamp() override;
         virtual void updateStep() override;
+        virtual void takeSnapshot() override;
 
         virtual void startWrite() override;
         virtual void readByte() override;
@@ -62,6 +63,7 @@ class Ssd1306 : public Component, public TwiModule
         dispColor m_dColor;
 
         unsigned char m_aDispRam[128][8]; //128x64 DDRAM
+        unsigned char m_frontRam[128][8]; // DDRAM at last frame, used in paint()
 
         int m_cdr;       // Clock Divide Ratio
         int m_mr;        // Multiplex Ratio
@@ -97,6 +99,12 @@ class Ssd1306 : public Component, public TwiModule
         bool m_scanInv;
         bool m_rotate;
 
+        bool m_frontOn;  // Display state at last frame
+        bool m_frontFull;
+        bool m_frontInv;
+        bool m_frontScanInv;
+        int  m_frontMr;
+
         //bool m_reset;
         bool m_command;
         bool m_data;
@@ -16,12 +16,12 @@
 
 #define tr(str) simulideTr("LedBase",str)
 
-eNode LedBase::m_gndEnode("");
 int   LedBase::m_overBright = 0;
 
 LedBase::LedBase( QString type, QString id )
        : Component( type, id )
        , eLed( id )
+       , m_gndEnode("")
 {
     m_graphical = true;
     m_grounded  = false;
@@ -51,7 +51,7 @@ class LedBase : public Component, public eLed
         
         LedColor m_ledColor;
 
-        static eNode m_gndEnode;
+        eNode m_gndEnode; // Ground for grounded Leds, belongs to the Simulator of this Led
 };
 
 #endif
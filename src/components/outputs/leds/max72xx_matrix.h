@@ -32,6 +32,8 @@ class Max72xx_matrix : public LogicComponent
         virtual void voltChanged() override;
         virtual void updateStep() override;
 
+        virtual bool saveState( QDataStream& out ) override { LogicComponent::saveState( out ); return false; } // Display Ram not saved
+
         virtual void setHidden( bool hid, bool hidArea=false, bool hidLabel=false ) override;
 
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget ) override;
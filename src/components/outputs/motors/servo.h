@@ -32,6 +32,8 @@ class Servo : public LogicComponent
         virtual void updateStep() override;
         virtual void voltChanged() override;
 
+        virtual bool saveState( QDataStream& out ) override { LogicComponent::saveState( out ); return false; } // Position not saved
+
         virtual QPainterPath shape() const override;
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget ) override;
 
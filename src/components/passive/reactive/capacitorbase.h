@@ -18,7 +18,10 @@ class CapacitorBase : public Reactive
 
     protected:
         virtual double updtRes()  override { return m_tStep/m_capacitance; }
-        virtual double updtCurr() override { return m_volt*m_admit; }
+        virtual double updtCurr() override { return m_hist*m_admit; }
+        virtual double getState( double volt ) override { return volt; }
+        virtual double initState() override { return m_InitVolt; }
+        virtual std::complex<double> acAdmit( double omega ) override { return std::complex<double>( 0, omega*m_capacitance ); }
 
         double m_capacitance;
 };
@@ -19,7 +19,7 @@ class Inductor : public Reactive
  static Component* construct( QString type, QString id );
  static LibraryItem* libraryItem();
 
-        double indCurrent() { return m_curSource; }
+        double indCurrent() { return m_x0; }
 
         virtual void setCurrentValue( double c ) override;
 
@@ -29,7 +29,10 @@ class Inductor : public Reactive
 
     protected:
         virtual double updtRes()  override { return m_inductance/m_tStep; }
-        virtual double updtCurr() override { return m_curSource - m_volt*m_admit; }
+        virtual double updtCurr() override { return -m_hist; }
+        virtual double getState( double volt ) override { return m_hist + volt*m_admit; }
+        virtual double initState() override { return -m_InitCurr; }
+        virtual std::complex<double> acAdmit( double omega ) override { return 1.0/std::complex<double>( 0, omega*m_inductance ); }
 
         double m_inductance;
 };
@@ -11,6 +11,7 @@
 #include "dialwidget.h"
 #include "propdialog.h"
 #include "simulator.h"
+#include "stimulus.h"
 #include "circuit.h"
 #include "itemlibrary.h"
 #include "e-node.h"
@@ -102,7 +103,24 @@ void Potentiometer::updateStep()
     if( !m_needUpdate ) return;
     m_needUpdate = false;
 
-    double res1 = double( m_resist*m_dialW.value()/1000 );
+    if( !Stimulus::self()->replaying() ) // Replaying: position comes from Stimulus log
+    {
+        int dialVal = m_dialW.value();
+        setDialRes( dialVal );
+        Stimulus::self()->addInput( this, QByteArray::number( dialVal ) );
+    }
+    if( m_propDialog ) m_propDialog->updtValues();
+    else setValLabelText( getPropStr( showProp() ) );
+}
+
+void Potentiometer::replayInput( const QByteArray& data )
+{
+    setDialRes( data.toInt() );
+}
+
+void Potentiometer::setDialRes( int dialVal )
+{
+    double res1 = double( m_resist*dialVal/1000 );
     double res2 = m_resist-res1;
 
     if( res1 < 1e-6 ){
@@ -115,9 +133,6 @@ void Potentiometer::updateStep()
     }
     m_resA.setRes( res1 );
     m_resB.setRes( res2 );
-
-    if( m_propDialog ) m_propDialog->updtValues();
-    else setValLabelText( getPropStr( showProp() ) );
 }
 
 double Potentiometer::getVal() { return m_resist*m_dialW.value()/1000; }
@@ -23,6 +23,7 @@ class Potentiometer : public Dialed, public eElement
 
         virtual void initialize() override;
         virtual void updateStep() override;
+        virtual void replayInput( const QByteArray& data ) override;
 
         double getVal();
         void setVal( double val );
@@ -38,6 +39,8 @@ class Potentiometer : public Dialed, public eElement
         virtual void updateProxy() override;
 
     private:
+        void setDialRes( int dialVal );
+
         double m_resist;
         double m_voltOut;
         double m_res1;
@@ -21,8 +21,6 @@
 
 #define tr(str) simulideTr("ResistorDip",str)
 
-eNode ResistorDip::m_puEnode("");
-
 Component* ResistorDip::construct( QString type, QString id )
 { return new ResistorDip( type, id ); }
 
@@ -39,6 +37,7 @@ LibraryItem* ResistorDip::libraryItem()
 ResistorDip::ResistorDip( QString type, QString id )
            : Component( type, id )
            , eElement( id )
+           , m_puEnode("")
 {
     m_pullUp = false;
     m_puVolt = 5;
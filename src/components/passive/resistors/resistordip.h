@@ -8,6 +8,7 @@
 
 #include "component.h"
 #include "e-element.h"
+#include "e-node.h"
 
 class LibraryItem;
 class eResistor;
@@ -61,7 +62,7 @@ class ResistorDip : public Component, public eElement
         std::vector<Pin*> m_pin;
         std::vector<eResistor*> m_resistor;
 
-        static eNode m_puEnode;
+        eNode m_puEnode; // Pull-up Voltage, belongs to the Simulator of this component
 };
 
 #endif
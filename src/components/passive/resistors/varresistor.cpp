@@ -8,6 +8,7 @@
 #include "varresistor.h"
 #include "itemlibrary.h"
 #include "simulator.h"
+#include "stimulus.h"
 
 #include "doubleprop.h"
 #include "propdialog.h"
@@ -55,11 +56,20 @@ void VarResistor::updateStep()
     if( !m_needUpdate ) return;
     m_needUpdate = false;
 
-    eResistor::setRes( m_value );
+    if( !Stimulus::self()->replaying() ) // Replaying: value comes from Stimulus log
+    {
+        eResistor::setRes( m_value );
+        Stimulus::self()->addInput( this, QByteArray::number( m_value, 'g', 17 ) );
+    }
     if( m_propDialog ) m_propDialog->updtValues();
     else setValLabelText( getPropStr( showProp() ) );
 }
 
+void VarResistor::replayInput( const QByteArray& data )
+{
+    eResistor::setRes( data.toDouble() );
+}
+
 void VarResistor::paint( QPainter* p, const QStyleOptionGraphicsItem* o, QWidget* w )
 {
     if( m_hidden ) return;
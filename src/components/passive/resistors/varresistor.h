@@ -20,6 +20,7 @@ class VarResistor : public VarResBase
  static LibraryItem* libraryItem();
 
         virtual void updateStep() override;
+        virtual void replayInput( const QByteArray& data ) override;
 
         virtual void paint( QPainter* p, const QStyleOptionGraphicsItem* o, QWidget* w ) override;
 };
@@ -8,6 +8,7 @@
 
 #include "switch_base.h"
 #include "simulator.h"
+#include "stimulus.h"
 #include "circuit.h"
 #include "label.h"
 #include "custombutton.h"
@@ -41,11 +42,20 @@ void SwitchBase::updateStep()
 {
     if( m_changed )
     {
-        setSwitch( m_closed );
+        if( !Stimulus::self()->replaying() ) // Replaying: state comes from Stimulus log
+        {
+            setSwitch( m_closed );
+            Stimulus::self()->addInput( this, QByteArray( 1, m_closed ) );
+        }
         m_changed = false;
         update();
 }   }
 
+void SwitchBase::replayInput( const QByteArray& data )
+{
+    setSwitch( data.at( 0 ) );
+}
+
 void SwitchBase::setAngle( double angle )
 {
     SwitchBase::rotateAngle( angle );
@@ -18,6 +18,7 @@ class SwitchBase : public MechContact
         ~SwitchBase();
 
         virtual void updateStep() override;
+        virtual void replayInput( const QByteArray& data ) override;
 
         virtual void setAngle( double angle ) override;
         virtual void rotateAngle( double a ) override;
@@ -0,0 +1,126 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QFileDialog>
+#include <QElapsedTimer>
+#include <QRegExp>
+
+#include "acdialog.h"
+#include "bodeplot.h"
+#include "mainwindow.h"
+#include "circuit.h"
+#include "utils.h"
+
+AcDialog::AcDialog( QWidget* parent )
+        : QDialog( parent )
+{
+    setWindowTitle( tr("AC Analysis") );
+
+    double scale = MainWindow::self()->fontScale();
+    QFont font( MainWindow::self()->defaultFontName(), 10 );
+    font.setPixelSize( 11*scale );
+    setFont( font );
+
+    m_sourceEdit = new QLineEdit( this );
+    m_sourceEdit->setToolTip( tr("Pin driven with 1 V AC, for example: WaveGen-1-outnod") );
+    m_probesEdit = new QLineEdit( this );
+    m_probesEdit->setToolTip( tr("Pins or Probes separated by commas, for example: Probe-1, Resistor-2-rPin") );
+    m_startEdit = new QLineEdit( "10 Hz", this );
+    m_stopEdit  = new QLineEdit( "1 MHz", this );
+    m_pointsBox = new QSpinBox( this );
+    m_pointsBox->setRange( 1, 1000 );
+    m_pointsBox->setValue( 20 );
+
+    QFormLayout* form = new QFormLayout();
+    form->addRow( tr("Source pin:"), m_sourceEdit );
+    form->addRow( tr("Probes:"), m_probesEdit );
+    form->addRow( tr("Start frequency:"), m_startEdit );
+    form->addRow( tr("Stop frequency:"), m_stopEdit );
+    form->addRow( tr("Points per decade:"), m_pointsBox );
+
+    m_statusLabel = new QLabel( tr("Start simulation: circuit is linearized at current state"), this );
+    m_runButton = new QPushButton( tr("Run"), this );
+    m_csvButton = new QPushButton( tr("Export CSV"), this );
+    m_csvButton->setEnabled( false );
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget( m_statusLabel );
+    buttonLayout->addStretch();
+    buttonLayout->addWidget( m_runButton );
+    buttonLayout->addWidget( m_csvButton );
+
+    m_plot = new BodePlot( this );
+
+    QVBoxLayout* layout = new QVBoxLayout( this );
+    layout->addLayout( form );
+    layout->addLayout( buttonLayout );
+    layout->addWidget( m_plot, 1 );
+
+    connect( m_runButton, &QPushButton::clicked, this, &AcDialog::runAnalysis, Qt::UniqueConnection );
+    connect( m_csvButton, &QPushButton::clicked, this, &AcDialog::exportCsv, Qt::UniqueConnection );
+
+    resize( 700*scale, 600*scale );
+}
+AcDialog::~AcDialog(){}
+
+void AcDialog::runAnalysis()
+{
+    bool okStart, okStop;
+    double start = toFreq( m_startEdit->text(), &okStart );
+    double stop  = toFreq( m_stopEdit->text(), &okStop );
+    if( !okStart || !okStop )
+    {
+        m_statusLabel->setText( tr("Wrong frequency") );
+        return;
+    }
+    m_analysis.setSource( m_sourceEdit->text().trimmed() );
+    m_analysis.setSweep( start, stop, m_pointsBox->value() );
+    m_analysis.clearProbes();
+
+    for( QString probe : m_probesEdit->text().split(",", QString::SkipEmptyParts ) )
+    {
+        probe = probe.trimmed();
+        if( probe.isEmpty() ) continue;
+        QString pinId = probe;
+        if( !Circuit::self()->getPin( pinId ) ) pinId = probe+"-inpin"; // Probe component
+        m_analysis.addProbe( probe, pinId );
+    }
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = m_analysis.run();
+    double ms = timer.nsecsElapsed()/1e6;
+
+    m_plot->setData( &m_analysis );
+    m_csvButton->setEnabled( ok );
+    if( ok ) m_statusLabel->setText( QString::number( m_analysis.freqs().size() )+" "+tr("points in")+" "
+                                    +QString::number( ms, 'f', 1 )+" ms" );
+    else     m_statusLabel->setText( tr("Error:")+" "+m_analysis.error() );
+}
+
+void AcDialog::exportCsv()
+{
+    QString fileName = QFileDialog::getSaveFileName( this, tr("Export CSV"), "ac_analysis.csv", "CSV (*.csv)" );
+    if( fileName.isEmpty() ) return;
+    if( !m_analysis.writeCsv( fileName ) ) m_statusLabel->setText( tr("Error: Cannot write file") );
+}
+
+double AcDialog::toFreq( QString text, bool* ok )
+{
+    QRegExp rx("^\\s*([0-9.]+(?:[eE][-+]?[0-9]+)?)\\s*([a-zA-Zµ]?)(?:Hz)?\\s*$");
+    *ok = rx.exactMatch( text );
+    if( !*ok ) return 0;
+
+    double value = rx.cap( 1 ).toDouble( ok );
+    if( !rx.cap( 2 ).isEmpty() ) value *= getMultiplier( rx.cap( 2 ) );
+    if( value <= 0 ) *ok = false;
+    return value;
+}
@@ -0,0 +1,51 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef ACDIALOG_H
+#define ACDIALOG_H
+
+#include <QDialog>
+
+#include "acanalysis.h"
+
+class QLineEdit;
+class QSpinBox;
+class QLabel;
+class QPushButton;
+class BodePlot;
+
+// AC analysis window: source, probes and frequency range, Bode plot of results
+
+class AcDialog : public QDialog
+{
+    Q_OBJECT
+
+    public:
+        AcDialog( QWidget* parent=0 );
+        ~AcDialog();
+
+    public slots:
+        void runAnalysis();
+        void exportCsv();
+
+    private:
+ static double toFreq( QString text, bool* ok ); // "10k", "1 MHz"...
+
+        AcAnalysis m_analysis;
+
+        QLineEdit* m_sourceEdit;
+        QLineEdit* m_probesEdit;
+        QLineEdit* m_startEdit;
+        QLineEdit* m_stopEdit;
+        QSpinBox*  m_pointsBox;
+
+        QPushButton* m_runButton;
+        QPushButton* m_csvButton;
+        QLabel*      m_statusLabel;
+
+        BodePlot* m_plot;
+};
+
+#endif
@@ -8,8 +8,11 @@
 #include "appdialog.h"
 #include "mainwindow.h"
 #include "simulator.h"
+#include "circmatrix.h"
 #include "circuit.h"
 #include "circuitwidget.h"
+#include "profilerwidget.h"
+#include "stimulus.h"
 
 AppDialog::AppDialog( QWidget* parent )
          : QDialog( parent )
@@ -32,6 +35,7 @@ AppDialog::AppDialog( QWidget* parent )
     showScroll->setChecked( CircuitView::self()->showScroll() );
     animate->setChecked( Circuit::self()->animate() );
     fps->setValue( Simulator::self()->fps() );
+    animFps->setValue( Simulator::self()->animFps() );
     backup->setValue( Circuit::self()->autoBck() );
 
     // Simulation Settings
@@ -56,8 +60,26 @@ AppDialog::AppDialog( QWidget* parent )
     reactStepBox->setValue( step );
     reactStepUnitBox->setCurrentIndex( unit );
 
+    reactIntegBox->setCurrentIndex( Simulator::self()->reactInteg() );
+    reactAdapt->setChecked( Simulator::self()->reactAdapt() );
+    reactMinBox->setValue( Simulator::self()->reactStepMin()/1e3 );
+    reactMaxBox->setValue( Simulator::self()->reactStepMax()/1e3 );
+    reactMinBox->setEnabled( Simulator::self()->reactAdapt() );
+    reactMaxBox->setEnabled( Simulator::self()->reactAdapt() );
+
+    maxSpeed->setChecked( Simulator::self()->maxSpeed() );
+    simSpeedPerSlider->setEnabled( !Simulator::self()->maxSpeed() );
+
     nlStepsBox->setValue( Simulator::self()->maxNlSteps() );
+    dcOpPoint->setChecked( Simulator::self()->dcOpPoint() );
+    nlBatch->setChecked( Simulator::self()->nlBatch() );
     slopeStepsBox->setValue( Simulator::self()->slopeSteps() );
+
+    parallelSolve->setChecked( CircMatrix::self()->parallel() );
+    parallelMinBox->setValue( CircMatrix::self()->parallelMin() );
+    parallelMinBox->setEnabled( CircMatrix::self()->parallel() );
+    profiler->setChecked( Simulator::self()->profiling() );
+    recordInputs->setChecked( Stimulus::self()->record() );
     m_blocked = false;
 
     updtSpeedPer();
@@ -147,6 +169,11 @@ void AppDialog::on_fps_valueChanged( int fps )
     Simulator::self()->setFps( fps );
 }
 
+void AppDialog::on_animFps_valueChanged( int fps )
+{
+    Simulator::self()->setAnimFps( fps );
+}
+
 void AppDialog::on_backup_valueChanged( int secs )
 {
     Circuit::self()->setAutoBck( secs );
@@ -219,11 +246,31 @@ void AppDialog::updtSpeedPer()
     updtSpeed();
 }
 
+void AppDialog::on_maxSpeed_toggled( bool m )
+{
+    if( m_blocked ) return;
+    Simulator::self()->setMaxSpeed( m );
+    simSpeedPerSlider->setEnabled( !m );
+}
+
 void AppDialog::on_nlStepsBox_editingFinished()
 {
     Simulator::self()->setMaxNlSteps( nlStepsBox->value() );
 }
 
+void AppDialog::on_dcOpPoint_toggled( bool op )
+{
+    if( m_blocked ) return;
+    Simulator::self()->setDcOpPoint( op );
+}
+
+void AppDialog::on_nlBatch_toggled( bool b )
+{
+    if( m_blocked ) return;
+    Simulator::self()->setNlBatch( b );
+    MainWindow::self()->settings()->setValue( "batchNonLinear", b );
+}
+
 void AppDialog::on_reactStepUnitBox_currentIndexChanged( int index )
 {
     updtReactStep();
@@ -242,11 +289,66 @@ void AppDialog::updtReactStep()
     Simulator::self()->setreactStep( reactStep );
 }
 
+void AppDialog::on_reactIntegBox_currentIndexChanged( int index )
+{
+    if( m_blocked ) return;
+    Simulator::self()->setReactInteg( index );
+}
+
+void AppDialog::on_reactAdapt_toggled( bool a )
+{
+    if( m_blocked ) return;
+    Simulator::self()->setReactAdapt( a );
+    reactMinBox->setEnabled( a );
+    reactMaxBox->setEnabled( a );
+}
+
+void AppDialog::on_reactMinBox_editingFinished()
+{
+    uint64_t stepMin = reactMinBox->value();
+    Simulator::self()->setReactStepMin( stepMin*1e3 );
+    on_reactMaxBox_editingFinished(); // Keep Max >= Min
+}
+
+void AppDialog::on_reactMaxBox_editingFinished()
+{
+    if( reactMaxBox->value() < reactMinBox->value() ) reactMaxBox->setValue( reactMinBox->value() );
+    uint64_t stepMax = reactMaxBox->value();
+    Simulator::self()->setReactStepMax( stepMax*1e3 );
+}
+
 void AppDialog::on_slopeStepsBox_editingFinished()
 {
     Simulator::self()->setSlopeSteps( slopeStepsBox->value() );
 }
 
+void AppDialog::on_parallelSolve_toggled( bool p )
+{
+    if( m_blocked ) return;
+    CircMatrix::self()->setParallel( p );
+    MainWindow::self()->settings()->setValue( "parallelSolve", p );
+    parallelMinBox->setEnabled( p );
+}
+
+void AppDialog::on_parallelMinBox_editingFinished()
+{
+    CircMatrix::self()->setParallelMin( parallelMinBox->value() );
+    MainWindow::self()->settings()->setValue( "parallelMin", parallelMinBox->value() );
+}
+
+void AppDialog::on_profiler_toggled( bool p )
+{
+    if( m_blocked ) return;
+    ProfilerWidget::self()->setProfiling( p );
+}
+
+void AppDialog::on_recordInputs_toggled( bool r )
+{
+    if( m_blocked ) return;
+    Stimulus::self()->setRecord( r );
+    MainWindow::self()->settings()->setValue( "recordInputs", r );
+}
+
 void AppDialog::on_fontName_currentFontChanged( const QFont &f )
 {
     MainWindow::self()->setDefaultFontName( f.family() );
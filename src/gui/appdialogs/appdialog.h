@@ -38,6 +38,7 @@ class AppDialog : public QDialog, private Ui::AppDialog
         void on_showScroll_toggled( bool show );
         void on_animate_toggled( bool ani );
         void on_fps_valueChanged( int fps );
+        void on_animFps_valueChanged( int fps );
         void on_backup_valueChanged( int secs );
 
         // Simulation Settings
@@ -46,13 +47,28 @@ class AppDialog : public QDialog, private Ui::AppDialog
         void on_simStepUnitBox_currentIndexChanged( int index );
         void on_simStepBox_editingFinished();
 
+        void on_maxSpeed_toggled( bool m );
+
         void on_nlStepsBox_editingFinished();
+        void on_dcOpPoint_toggled( bool op );
+        void on_nlBatch_toggled( bool b );
 
         void on_reactStepUnitBox_currentIndexChanged( int index );
         void on_reactStepBox_editingFinished();
 
+        void on_reactIntegBox_currentIndexChanged( int index );
+        void on_reactAdapt_toggled( bool a );
+        void on_reactMinBox_editingFinished();
+        void on_reactMaxBox_editingFinished();
+
         void on_slopeStepsBox_editingFinished();
 
+        void on_parallelSolve_toggled( bool p );
+        void on_parallelMinBox_editingFinished();
+
+        void on_profiler_toggled( bool p );
+        void on_recordInputs_toggled( bool r );
+
     private slots:
         void on_fontName_currentFontChanged( const QFont &f );
 
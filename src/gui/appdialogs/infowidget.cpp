@@ -3,8 +3,13 @@
  *                                                                         *
  ***( see copyright.txt file at root folder )*******************************/
 
+#include <QToolButton>
+#include <QLabel>
+#include <algorithm>
+
 #include "infowidget.h"
 #include "mainwindow.h"
+#include "simulator.h"
 #include "mcu.h"
 
 InfoWidget* InfoWidget::m_pSelf = nullptr;
@@ -39,14 +44,95 @@ InfoWidget::InfoWidget( QWidget* parent )
 
     overLoadLabel->setVisible( false );
     overLoadVal->setVisible( false );
+
+    m_statsVisible = false;  // Engine statistics: expandable view
+
+    m_statsButton = new QToolButton( this );
+    m_statsButton->setFont( font );
+    m_statsButton->setText( tr("Engine Statistics") );
+    m_statsButton->setToolButtonStyle( Qt::ToolButtonTextBesideIcon );
+    m_statsButton->setArrowType( Qt::RightArrow );
+    m_statsButton->setAutoRaise( true );
+    m_statsButton->setCheckable( true );
+
+    QFont monoFont( "Monospace" );
+    monoFont.setStyleHint( QFont::TypeWriter );
+    monoFont.setPixelSize( 11*fontScale );
+
+    m_statsLabel = new QLabel( this );
+    m_statsLabel->setFont( monoFont );
+    m_statsLabel->setTextInteractionFlags( Qt::TextSelectableByMouse );
+    m_statsLabel->setText( "  ---" );
+    m_statsLabel->setVisible( false );
+
+    verticalLayout->addWidget( m_statsButton );
+    verticalLayout->addWidget( m_statsLabel );
+
+    connect( m_statsButton, &QToolButton::toggled, this, &InfoWidget::showStats, Qt::UniqueConnection );
+}
+
+void InfoWidget::showStats( bool show )
+{
+    m_statsVisible = show;
+    m_statsButton->setArrowType( show ? Qt::DownArrow : Qt::RightArrow );
+    m_statsLabel->setVisible( show );
+
+    QSize size = verticalLayout->sizeHint(); // Layout widget has fixed geometry
+    verticalLayoutWidget->resize( std::max( size.width(), verticalLayoutWidget->width() ), size.height() );
+    setMinimumWidth( verticalLayoutWidget->width() );
+    if( show ) setMinimumHeight( verticalLayoutWidget->height() );
+    else       setMinimumHeight( 0 );
+}
+
+void InfoWidget::setStats( const simStats_t& stats )
+{
+    auto line = []( QString label, uint64_t value ){
+        return "  "+label.leftJustified( 16, ' ' )+QString::number( value ).rightJustified( 14, ' ' )+"\n";
+    };
+    QString text;
+    text += line( tr("Events"),         stats.events );
+    text += line( tr("  Cancelled"),    stats.cancelled );
+    text += line( tr("  Peak queue"),   stats.peakQueue );
+    text += line( tr("Matrix solves"),  stats.matrixSolves );
+    text += line( tr("Factorizations"), stats.factorizations );
+    text += line( tr("Group solves"),   stats.groupSolves );
+    text += line( tr("NL iterations"),  stats.nlIterations );
+    text += line( tr("voltChanged"),    stats.voltChanged );
+    text += line( tr("setVolt changes"),stats.voltSets );
+    text += line( tr("Idle jumps"),     stats.idleSkips );
+
+    std::vector<int> groups( stats.groups.size() ); // Busiest groups first
+    for( uint g=0; g<groups.size(); ++g ) groups[g] = g;
+    std::sort( groups.begin(), groups.end(), [&stats]( int a, int b )
+               { return stats.groups[a].solves > stats.groups[b].solves; } );
+
+    if( !groups.empty() ) text += "\n  "+tr("Group Nodes  Factors   Solves NL iter.")+"\n";
+    int shown = std::min( (int)groups.size(), 12 );
+    for( int i=0; i<shown; ++i )
+    {
+        const groupStats_t& group = stats.groups[groups[i]];
+        text += "  "+QString::number( groups[i] ).rightJustified( 5, ' ' )
+                    +QString::number( group.nodes ).rightJustified( 6, ' ' )
+                    +QString::number( group.factors ).rightJustified( 9, ' ' )
+                    +QString::number( group.solves ).rightJustified( 9, ' ' )
+                    +QString::number( group.nlIters ).rightJustified( 9, ' ' )+"\n";
+    }
+    if( shown < (int)groups.size() ) text += "  ... "+QString::number( groups.size()-shown )+" "+tr("more groups")+"\n";
+
+    text.chop( 1 ); // Last "\n"
+    m_statsLabel->setText( text );
+    if( m_statsVisible ) showStats( true ); // Fit layout to new text
 }
 
 void InfoWidget::setTargetSpeed( double s )
 {
-    QString speed = QString::number( s,'f', 2 )+" %";
-    if( s < 100 ) speed = "0"+speed;
-    if( s < 10 )  speed = "0"+speed;
-    targetSpeed->setText("  "+speed );
+    if( s < 0 ) targetSpeed->setText("  "+tr("Max Speed") );
+    else{
+        QString speed = QString::number( s,'f', 2 )+" %";
+        if( s < 100 ) speed = "0"+speed;
+        if( s < 10 )  speed = "0"+speed;
+        targetSpeed->setText("  "+speed );
+    }
     updtMcu();
 }
 
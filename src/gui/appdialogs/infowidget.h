@@ -10,6 +10,10 @@
 
 #include "ui_infowidget.h"
 
+class QToolButton;
+class QLabel;
+struct simStats_t;
+
 class InfoWidget : public QWidget, private Ui::infoWidget
 {
     Q_OBJECT
@@ -24,10 +28,19 @@ class InfoWidget : public QWidget, private Ui::infoWidget
         void setTargetSpeed( double s );
         void updtMcu();
 
+        bool statsVisible() { return m_statsVisible; }
+        void setStats( const simStats_t& stats );
+
     public slots:
+        void showStats( bool show );
 
     private:
  static InfoWidget* m_pSelf;
+
+        bool m_statsVisible;
+
+        QToolButton* m_statsButton;
+        QLabel*      m_statsLabel;
 };
 
 #endif
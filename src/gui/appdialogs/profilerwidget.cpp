@@ -0,0 +1,201 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QTextStream>
+#include <QFile>
+
+#include "profilerwidget.h"
+#include "mainwindow.h"
+#include "simulator.h"
+#include "circmatrix.h"
+#include "e-element.h"
+
+ProfilerWidget* ProfilerWidget::m_pSelf = nullptr;
+
+ProfilerWidget::ProfilerWidget( QWidget* parent )
+              : QWidget( parent )
+              , Updatable()
+{
+    m_pSelf = this;
+    m_snapshot = true;
+    m_totalTime = 0;
+    m_newData = false;
+
+    double scale = MainWindow::self()->fontScale();
+    QFont font( MainWindow::self()->defaultFontName(), 10 );
+    font.setPixelSize( 11*scale );
+
+    m_table = new QTableWidget( 0, 9, this );
+    m_table->setHorizontalHeaderLabels( { tr("Element"), tr("Events"), tr("Event ms")
+                                        , tr("Volt Ch."), tr("Volt ms"), tr("NL Iter."), tr("NL ms")
+                                        , tr("Solves"), tr("Total ms") } );
+    m_table->setFont( font );
+    m_table->setEditTriggers( QAbstractItemView::NoEditTriggers );
+    m_table->setSelectionBehavior( QAbstractItemView::SelectRows );
+    m_table->verticalHeader()->setVisible( false );
+    m_table->verticalHeader()->setDefaultSectionSize( 16*scale );
+    m_table->horizontalHeader()->setFont( font );
+    m_table->horizontalHeader()->setSectionResizeMode( 0, QHeaderView::Stretch );
+    m_table->setSortingEnabled( true );
+    m_table->sortByColumn( 8, Qt::DescendingOrder );
+
+    m_totalLabel  = new QLabel( this );
+    m_totalLabel->setFont( font );
+    m_resetButton = new QPushButton( tr("Reset"), this );
+    m_resetButton->setFont( font );
+    m_csvButton   = new QPushButton( tr("Export CSV"), this );
+    m_csvButton->setFont( font );
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget( m_totalLabel );
+    buttonLayout->addStretch();
+    buttonLayout->addWidget( m_resetButton );
+    buttonLayout->addWidget( m_csvButton );
+
+    QVBoxLayout* layout = new QVBoxLayout( this );
+    layout->setContentsMargins( 0, 0, 0, 0 );
+    layout->setSpacing( 2 );
+    layout->addLayout( buttonLayout );
+    layout->addWidget( m_table );
+
+    connect( m_resetButton, &QPushButton::clicked, this, &ProfilerWidget::reset, Qt::UniqueConnection );
+    connect( m_csvButton,   &QPushButton::clicked, this, &ProfilerWidget::exportCsv, Qt::UniqueConnection );
+
+    setVisible( false );
+}
+ProfilerWidget::~ProfilerWidget(){}
+
+void ProfilerWidget::setProfiling( bool p )
+{
+    Simulator::self()->setProfiling( p );
+    if( p ){
+        Simulator::self()->addToUpdateList( this );
+        m_refresh.start();
+    }
+    else Simulator::self()->remFromUpdateList( this );
+
+    setVisible( p );
+}
+
+void ProfilerWidget::reset()
+{
+    Simulator::self()->resetProfile();
+    m_rows.clear();
+    m_totalTime = 0;
+    m_newData = true;
+    updateStep();
+}
+
+void ProfilerWidget::takeSnapshot() // Simulation stopped: copy counters
+{
+    if( Simulator::self()->isRunning() && m_refresh.elapsed() < 1000 ) return;
+    m_refresh.start();
+
+    m_rows.clear();
+    m_totalTime = 0;
+
+    for( eElement* el : Simulator::self()->elementList() )
+    {
+        const eElement::profile_t& p = el->profile;
+        if( !p.events && !p.voltChanges && !p.nlIters ) continue;
+
+        row_t row;
+        row.name        = el->getId();
+        row.events      = p.events;
+        row.eventTime   = p.eventTime/1e6;
+        row.voltChanges = p.voltChanges;
+        row.voltTime    = p.voltTime/1e6;
+        row.nlIters     = p.nlIters;
+        row.nlTime      = p.nlTime/1e6;
+        row.solves      = 0;
+        row.totalTime   = row.eventTime+row.voltTime+row.nlTime;
+        m_rows.push_back( row );
+        m_totalTime += row.totalTime;
+    }
+    Simulator* sim = Simulator::self();
+    CircMatrix* matrix = CircMatrix::self();
+    for( int g=-1; g<matrix->groups(); ++g ) // -1: single eNodes
+    {
+        row_t row = { "", 0, 0, 0, 0, 0, 0, 0, 0 };
+        row.nlIters = sim->nlGroupIters( g );
+        if( g < 0 ){
+            if( !row.nlIters ) continue;
+            row.name = tr("Single nodes");
+        }else{
+            if( !matrix->groupSolves( g ) ) continue;
+            row.name = tr("Matrix group %1 (%2 nodes)").arg( g ).arg( matrix->groupSize( g ) );
+            row.solves    = matrix->groupSolves( g );
+            row.totalTime = matrix->groupTime( g )/1e6;
+        }
+        uint64_t fails = sim->nlGroupFails( g );
+        if( fails ) row.name += " "+tr("NonLinear Not Converging: %1").arg( fails );
+        m_rows.push_back( row );
+        m_totalTime += row.totalTime;
+    }
+    m_newData = true;
+}
+
+void ProfilerWidget::updateStep()
+{
+    if( !m_newData ) return;
+    m_newData = false;
+
+    m_table->setSortingEnabled( false ); // Don't sort while filling
+    m_table->setRowCount( m_rows.size() );
+
+    int r = 0;
+    for( const row_t& row : m_rows )
+    {
+        QVariant values[9] = { row.name, (qulonglong)row.events, row.eventTime, (qulonglong)row.voltChanges, row.voltTime
+                             , (qulonglong)row.nlIters, row.nlTime, (qulonglong)row.solves, row.totalTime };
+        for( int c=0; c<9; ++c )
+        {
+            QTableWidgetItem* item = m_table->item( r, c );
+            if( !item ){
+                item = new QTableWidgetItem();
+                m_table->setItem( r, c, item );
+            }
+            item->setData( Qt::DisplayRole, values[c] ); // Numbers sorted as numbers
+        }
+        r++;
+    }
+    m_table->setSortingEnabled( true );
+    m_totalLabel->setText( "  "+tr("Total:")+" "+QString::number( m_totalTime, 'f', 1 )+" ms" );
+}
+
+void ProfilerWidget::exportCsv()
+{
+    QString dir = MainWindow::self()->settings()->value("lastCircDir").toString();
+    QString fileName = QFileDialog::getSaveFileName( this, tr("Export Profile"), dir,
+                                                     tr("CSV files (*.csv);;All files (*.*)") );
+    if( fileName.isEmpty() ) return;
+    if( !fileName.endsWith(".csv") ) fileName.append(".csv");
+
+    QFile file( fileName );
+    if( !file.open( QFile::WriteOnly | QFile::Text ) )
+    {
+        QMessageBox::warning( this, "ProfilerWidget::exportCsv",
+                              tr("Cannot write file %1:\n%2.").arg( fileName ).arg( file.errorString() ) );
+        return;
+    }
+    QTextStream out( &file );
+    out << "Element,Events,Event ms,Volt Changes,Volt ms,NL Iterations,NL ms,Solves,Total ms\n";
+    for( const row_t& row : m_rows )
+    {
+        out << "\""+row.name+"\"," << row.events << "," << row.eventTime << ","
+            << row.voltChanges << "," << row.voltTime << ","
+            << row.nlIters << "," << row.nlTime << ","
+            << row.solves << "," << row.totalTime << "\n";
+    }
+    file.close();
+}
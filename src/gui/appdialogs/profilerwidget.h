@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef PROFILERWIDGET_H
+#define PROFILERWIDGET_H
+
+#include <QWidget>
+#include <QElapsedTimer>
+#include <vector>
+
+#include "updatable.h"
+
+class QTableWidget;
+class QPushButton;
+class QLabel;
+
+// Time used by each eElement and matrix group while simulation runs.
+// Counters are copied in takeSnapshot() once per second and shown in updateStep().
+
+class ProfilerWidget : public QWidget, public Updatable
+{
+    Q_OBJECT
+
+    public:
+        ProfilerWidget( QWidget* parent=0 );
+        ~ProfilerWidget();
+
+ static ProfilerWidget* self() { return m_pSelf; }
+
+        void setProfiling( bool p );
+
+        virtual void takeSnapshot() override;
+        virtual void updateStep() override;
+
+    public slots:
+        void reset();
+        void exportCsv();
+
+    private:
+ static ProfilerWidget* m_pSelf;
+
+        struct row_t
+        {
+            QString  name;
+            uint64_t events;
+            double   eventTime;  // ms
+            uint64_t voltChanges;
+            double   voltTime;
+            uint64_t nlIters;
+            double   nlTime;
+            uint64_t solves;
+            double   totalTime;
+        };
+
+        QTableWidget* m_table;
+        QPushButton*  m_resetButton;
+        QPushButton*  m_csvButton;
+        QLabel*       m_totalLabel;
+
+        std::vector<row_t> m_rows;
+        double m_totalTime;
+        bool   m_newData;
+
+        QElapsedTimer m_refresh;
+};
+
+#endif
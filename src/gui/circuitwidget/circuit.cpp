@@ -29,12 +29,13 @@
 #include "tunnel.h"
 #include "createcomp.h"
 
-Circuit* Circuit::m_pSelf = NULL;
+thread_local Circuit* Circuit::m_pSelf = NULL;
 
 Circuit::Circuit( qreal x, qreal y, qreal width, qreal height, CircuitView*  parent )
        : QGraphicsScene( x, y, width, height, parent )
 {
-    m_simulator = new Simulator();
+    m_pSelf = this;
+    m_simulator = new Simulator(); // Simulator gets this Circuit
     Tunnel::clearTunnels();
 
     setObjectName( "Circuit" );
@@ -43,8 +44,6 @@ Circuit::Circuit( qreal x, qreal y, qreal width, qreal height, CircuitView*  par
     m_scenerect.setRect( x, y, width, height );
     setSceneRect( QRectF(x, y, width, height) );
 
-    m_pSelf = this;
-
     m_busy       = false;
     m_undo       = false;
     m_redo       = false;
@@ -86,6 +85,7 @@ Circuit::~Circuit()
 
     cancelComp();
 
+    if( !m_graphicView ) return; // Not the main Circuit: backup file is not ours
     QFile file( m_backupPath );
     if( !file.exists() ) return;
     QFile::remove( m_backupPath ); // Remove backup file
@@ -162,7 +162,7 @@ void Circuit::loadCircuit( QString fileName )
 
     if( m_error != 0 ) clearCircuit();
     else{
-        m_graphicView->zoomToFit();
+        if( m_graphicView ) m_graphicView->zoomToFit(); // No view: sweep runner circuits
         qDebug() << "Circuit Loaded: ";
         qDebug() << fileName;
 }   }
@@ -450,8 +450,15 @@ void Circuit::loadStrDoc( QString &doc )
                     if     ( name == "stepSize") m_simulator->setStepSize( prop.toULongLong() );
                     else if( name == "stepsPS" ) m_simulator->setStepsPerSec(prop.toULongLong() );
                     else if( name == "NLsteps" ) m_simulator->setMaxNlSteps( prop.toUInt() );
+                    else if( name == "opPoint" ) m_simulator->setDcOpPoint( prop.toInt() );
                     else if( name == "reaStep" ) m_simulator->setreactStep( prop.toULongLong() );
+                    else if( name == "reaInteg") m_simulator->setReactInteg( prop.toInt() );
+                    else if( name == "reaAdapt") m_simulator->setReactAdapt( prop.toInt() );
+                    else if( name == "reaMin"  ) m_simulator->setReactStepMin( prop.toULongLong() );
+                    else if( name == "reaMax"  ) m_simulator->setReactStepMax( prop.toULongLong() );
+                    else if( name == "reaTol"  ) m_simulator->setReactTol( prop.toDouble() );
                     else if( name == "animate" ) setAnimate( prop.toInt() );
+                    else if( name == "maxSpeed") m_simulator->setMaxSpeed( prop.toInt() );
                     else if( name == "rev"     ) rev = prop.toInt();
                     else if( name == "category") m_category = prop.toString();
                     else if( name == "icondata") m_iconData = prop.toString();
@@ -525,8 +532,15 @@ QString Circuit::circuitHeader()
     header += "stepSize=\""+ QString::number( m_simulator->stepSize() )+"\" ";
     header += "stepsPS=\"" + QString::number( m_simulator->stepsPerSec() )+"\" ";
     header += "NLsteps=\"" + QString::number( m_simulator->maxNlSteps() )+"\" ";
+    header += "opPoint=\"" + QString::number( m_simulator->dcOpPoint() )+"\" ";
     header += "reaStep=\"" + QString::number( m_simulator->reactStep() )+"\" ";
+    header += "reaInteg=\""+ QString::number( m_simulator->reactInteg() )+"\" ";
+    header += "reaAdapt=\""+ QString::number( m_simulator->reactAdapt() )+"\" ";
+    header += "reaMin=\"" + QString::number( m_simulator->reactStepMin() )+"\" ";
+    header += "reaMax=\"" + QString::number( m_simulator->reactStepMax() )+"\" ";
+    header += "reaTol=\"" + QString::number( m_simulator->reactTol() )+"\" ";
     header += "animate=\"" + QString::number( m_animate )+"\" ";
+    header += "maxSpeed=\""+ QString::number( m_simulator->maxSpeed() )+"\" ";
     header += ">\n";
     return header;
 }
@@ -20,6 +20,7 @@ class CircuitView;
 class SubPackage;
 class Simulator;
 class Node;
+class Tunnel;
 
 class Circuit : public QGraphicsScene
 {
@@ -34,6 +35,8 @@ class Circuit : public QGraphicsScene
 
  static Circuit* self() { return m_pSelf; }
 
+        void makeCurrent() { m_pSelf = this; } // Called by Simulator::makeCurrent()
+
         bool drawGrid() { return !m_hideGrid; }
         void setDrawGrid( bool draw );
 
@@ -91,8 +94,10 @@ class Circuit : public QGraphicsScene
         QList<Connector*>* conList()  { return &m_connList; }
         QList<Node*>*      nodeList() { return &m_nodeList; }
         QHash<QString, CompBase*>* compMap() { return &m_compMap;}
+        QHash<QString, QList<Tunnel*>*>* tunnelMap() { return &m_tunnelMap; }
 
         Component* getCompById( QString id );
+        Pin* getPin( QString pinId ) { return m_pinMap.value( pinId ); }
         QString origId( QString name ) { return m_idMap.value( name ); } // used by Shield
 
         bool is_constarted() { return m_conStarted ; }
@@ -111,6 +116,8 @@ class Circuit : public QGraphicsScene
         QString getSeqNumber( QString name );
         QString replaceId( QString pinName );
 
+        Simulator* simulator() { return m_simulator; }
+
         const QString getFilePath() const { return m_filePath; }
         void setFilePath( QString f ) { m_filePath = f; }
 
@@ -150,7 +157,7 @@ class Circuit : public QGraphicsScene
         void dropEvent( QGraphicsSceneDragDropEvent* event );
 
     private:
- static Circuit*  m_pSelf;
+ static thread_local Circuit* m_pSelf;
 
         void loadStrDoc( QString &doc );
 
@@ -202,6 +209,7 @@ class Circuit : public QGraphicsScene
         QHash<QString, Pin*>      m_LdPinMap; // Pin Id to Pin* while loading/pasting/importing
         QHash<QString, QString>   m_idMap;    // Component seqNumber to new seqNumber (pasting)
         QHash<QString, CompBase*> m_compMap;  // Component Id to Component*
+        QHash<QString, QList<Tunnel*>*> m_tunnelMap; // Tunnel name to Tunnels
 
         QTimer m_bckpTimer;
 
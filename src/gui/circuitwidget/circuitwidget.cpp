@@ -16,8 +16,10 @@
 #include "simulator.h"
 #include "circuit.h"
 #include "appdialog.h"
+#include "acdialog.h"
 #include "filebrowser.h"
 #include "infowidget.h"
+#include "profilerwidget.h"
 #include "about.h"
 #include "utils.h"
 
@@ -37,6 +39,7 @@ CircuitWidget::CircuitWidget( QWidget *parent  )
 
     m_appPropW = NULL;
     m_about = NULL;
+    m_acDialog = NULL;
 
     m_verticalLayout.setObjectName( "verticalLayout" );
     m_verticalLayout.setContentsMargins(0, 0, 0, 0);
@@ -52,12 +55,15 @@ CircuitWidget::CircuitWidget( QWidget *parent  )
     m_infoWidget = new InfoWidget( this );
     m_infoWidget->setTargetSpeed( 100 );
 
+    m_profWidget = new ProfilerWidget( this );
+
     m_panelSplitter = new QSplitter( this );
     m_panelSplitter->setObjectName("Panelplitter");
     m_panelSplitter->setOrientation( Qt::Horizontal );
     m_panelSplitter->addWidget( m_infoWidget );
+    m_panelSplitter->addWidget( m_profWidget );
     m_panelSplitter->addWidget( &m_outPane );
-    m_panelSplitter->setSizes( {170, 500} );
+    m_panelSplitter->setSizes( {170, 300, 500} );
 
     m_mainSplitter->addWidget( &m_circView );
     m_mainSplitter->addWidget( m_panelSplitter );
@@ -94,6 +100,13 @@ void CircuitWidget::clear()
         m_appPropW->deleteLater();
         m_appPropW = NULL;
     }
+    if( m_acDialog )
+    {
+        m_acDialog->setParent( NULL );
+        m_acDialog->close();
+        m_acDialog->deleteLater();
+        m_acDialog = NULL;
+    }
     m_circView.clear();
     m_infoWidget->setCircTime( 0 );
 }
@@ -154,6 +167,11 @@ void CircuitWidget::createActions()
     connect( pauseSimAct, &QAction::triggered,
              this, &CircuitWidget::pauseCirc, Qt::UniqueConnection );
 
+    acAnalysisAct = new QAction( QIcon(":/frequencimeter.png"),tr("AC Analysis"), this);
+    acAnalysisAct->setStatusTip(tr("AC Analysis"));
+    connect( acAnalysisAct, &QAction::triggered,
+                      this, &CircuitWidget::acAnalysis, Qt::UniqueConnection );
+
     settAppAct = new QAction( QIcon(":/config.svg"),tr("Settings"), this);
     settAppAct->setStatusTip(tr("Settings"));
     connect( settAppAct, &QAction::triggered,
@@ -216,6 +234,7 @@ void CircuitWidget::createToolBars()
 
     m_circToolBar.addAction( powerCircAct );
     m_circToolBar.addAction( pauseSimAct );
+    m_circToolBar.addAction( acAnalysisAct );
     m_circToolBar.addSeparator();//..........................
 
     spacer = new QWidget();
@@ -462,6 +481,17 @@ void CircuitWidget::settApp()
     m_appPropW->show();
 }
 
+void CircuitWidget::acAnalysis()
+{
+    if( !m_acDialog )
+    {
+        m_acDialog = new AcDialog( this );
+        QPoint p = mapToGlobal( QPoint(50, 50) );
+        m_acDialog->move( p.x(), p.y() );
+    }
+    m_acDialog->show();
+}
+
 void CircuitWidget::openInfo()
 { QDesktopServices::openUrl(QUrl("http://simulide.com")); }
 
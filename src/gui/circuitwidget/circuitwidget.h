@@ -17,7 +17,9 @@ class QSplitter;
 class QLabel;
 class AboutDialog;
 class AppDialog;
+class AcDialog;
 class InfoWidget;
+class ProfilerWidget;
 
 class CircuitWidget : public QWidget
 {
@@ -56,6 +58,7 @@ class CircuitWidget : public QWidget
         void powerCirc();
         void pauseCirc();
         void settApp();
+        void acAnalysis();
         void openInfo();
         void about();
 
@@ -80,6 +83,7 @@ class CircuitWidget : public QWidget
 
         QLabel* m_msgLabel;
         InfoWidget* m_infoWidget;
+        ProfilerWidget* m_profWidget;
 
         QSplitter* m_mainSplitter;
         QSplitter* m_panelSplitter;
@@ -94,6 +98,7 @@ class CircuitWidget : public QWidget
         QAction* zoomOneAct;
         QAction* powerCircAct;
         QAction* pauseSimAct;
+        QAction* acAnalysisAct;
         QAction* settAppAct;
         QAction* infoAct;
         QAction* aboutAct;
@@ -107,6 +112,7 @@ class CircuitWidget : public QWidget
 
         AppDialog*   m_appPropW;
         AboutDialog* m_about;
+        AcDialog*    m_acDialog;
 };
 
 #endif
@@ -49,6 +49,7 @@ class CompBase
 
         virtual bool    setPropStr( QString prop, QString val );
         virtual QString getPropStr( QString prop );
+        bool hasProp( QString prop ) { return m_propHash.contains( prop ); }
 
         virtual QString toString();
 
@@ -401,3 +401,10 @@ QString Connector::startPinId() { return m_startPin->pinId(); }
 QString Connector::endPinId()   { return m_endPin->pinId(); }
 
 double Connector::getVoltage() { return m_startPin->getVoltage(); }
+
+double Connector::frontVolt()
+{
+    eNode* enode = m_startPin->getEnode();
+    if( enode ) return enode->frontVolt();
+    return 0;
+}
@@ -32,6 +32,7 @@ class Connector : public CompBase
         void setEndPin( Pin* pin) { m_endPin = pin; }
 
         double getVoltage();
+        double frontVolt(); // Voltage at last frame, safe to read while simulation runs
 
         QList<ConnectorLine*>* lineList() { return &m_conLineList; }
 
@@ -356,7 +356,7 @@ void ConnectorLine::paint( QPainter* p, const QStyleOptionGraphicsItem* option,
     else if( m_isBus ) color =  Qt::darkGreen;
     else if( Circuit::self()->animate() )
     {
-        if( m_pConnector->getVoltage() > 2.5 ) color = QColor( 200, 50, 50  );
+        if( m_pConnector->frontVolt() > 2.5 ) color = QColor( 200, 50, 50  );
         else                                   color = QColor( 50,  50, 200 );
     }
     else color = QColor( 40, 40, 60 /*Qt::black*/ );
@@ -4,6 +4,7 @@
  ***( see copyright.txt file at root folder )*******************************/
 
 #include <QtMath>
+#include <QDataStream>
 
 #include "iopin.h"
 #include "simulator.h"
@@ -62,10 +63,11 @@ void IoPin::stamp()
     ePin::createCurrent();
     setPinMode( m_pinMode );
     stampAll();
-    updateStep();
+    IoPin::takeSnapshot();
+    update();
 }
 
-void IoPin::updateStep()
+void IoPin::takeSnapshot() // Simulation stopped: get Pin state from Voltages
 {
     if( m_unused ) return;
 
@@ -85,7 +87,7 @@ void IoPin::updateStep()
             case source: m_pinState = state? out_high : out_low; break;
         }
     }
-    update();
+    m_paintState = m_pinState;
 }
 
 void IoPin::runEvent()
@@ -115,6 +117,22 @@ void IoPin::runEvent()
     }
 }
 
+bool IoPin::saveState( QDataStream& out )
+{
+    out << (qint32)m_pinMode << m_outState << m_nextState << m_inpState << m_stateZ << (qint32)m_step
+        << m_outVolt << m_admit << m_vddAdmit << m_gndAdmit << m_vddAdmEx << m_gndAdmEx;
+    return true;
+}
+
+void IoPin::loadState( QDataStream& in ) // Stamped values are restored in eNode
+{
+    qint32 mode, step;
+    in >> mode >> m_outState >> m_nextState >> m_inpState >> m_stateZ >> step
+       >> m_outVolt >> m_admit >> m_vddAdmit >> m_gndAdmit >> m_vddAdmEx >> m_gndAdmEx;
+    m_pinMode = (pinMode_t)mode;
+    m_step = step;
+}
+
 void IoPin::scheduleState( bool state, uint64_t time )
 {
     if( m_nextState == state ) return;
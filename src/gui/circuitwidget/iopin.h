@@ -32,9 +32,12 @@ class IoPin : public Pin, public eElement
 
         virtual void initialize() override;
         virtual void stamp() override;
-        virtual void updateStep() override;
+        virtual void takeSnapshot() override;
         virtual void runEvent() override;
 
+        virtual bool saveState( QDataStream& out ) override;
+        virtual void loadState( QDataStream& in ) override;
+
         virtual void scheduleState( bool state, uint64_t time );
 
         //pinMode_t pinMode() { return m_pinMode; }
@@ -140,6 +143,6 @@ class IoPin : public Pin, public eElement
 
         pinMode_t m_pinMode;
 
-        static eNode m_gndEnode;
+        static eNode m_gndEnode; // Only read with getVolt(): not attached to any Simulator
 };
 #endif
@@ -27,6 +27,8 @@ Pin::Pin( int angle, const QPoint pos, QString id, int index, Component* parent,
     m_component = parent;
     m_pinState = undef_state;
     m_pinType  = pinNormal;
+    m_paintState = undef_state;
+    m_snapshot   = true;
 
     m_blocked = false;
     m_isBus   = false;
@@ -364,6 +366,7 @@ void Pin::animate( bool an )
 {
     if( m_unused || m_isBus ) return;
     m_animate = an;
+    m_paintState = m_pinState;
 
     if     (  m_animate ) Simulator::self()->addToUpdateList( this );
     else if( !m_warning ) Simulator::self()->remFromUpdateList( this );
@@ -416,7 +419,7 @@ void Pin::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
 
     if     ( m_unused  ) pen.setColor( QColor( 75, 120, 170 ));
     else if( m_isBus   ) pen.setColor( Qt::darkGreen );
-    else if( m_animate ) pen.setColor( m_color[m_pinState] );
+    else if( m_animate ) pen.setColor( m_color[m_paintState] );
 
     painter->setPen(pen);
     if( m_length > 1 ) painter->drawLine( QPointF(0, 0), QPointF( m_length-0.7, 0) );
@@ -435,14 +438,14 @@ void Pin::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
     {
         pen.setWidthF( 1.5 );
         painter->setPen(pen);
-        if( m_pinState >= input_low ) // Draw Input arrow
+        if( m_paintState >= input_low ) // Draw Input arrow
         {
             painter->drawLine( 2, 0, 0, 2);
             painter->drawLine( 0,-2, 2, 0);
         }else{
-            if( m_pinState >= out_low ) // Draw lower half Output arrow
+            if( m_paintState >= out_low ) // Draw lower half Output arrow
             painter->drawLine( 0, 0, 2, 2);
-            if( m_pinState >= driven_low )
+            if( m_paintState >= driven_low )
             painter->drawLine( 2,-2, 0, 0);// Draw upper half Output arrow
         }
 }   }
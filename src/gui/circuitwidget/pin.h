@@ -104,6 +104,7 @@ class Pin : public QGraphicsItem, public ePin, public Updatable
         void warning( bool w );
         void animate( bool an );
         virtual void updateStep() override;
+        virtual void takeSnapshot() override { m_paintState = m_pinState; }
 
         virtual Pin* getPin() override { return this; }
 
@@ -117,6 +118,7 @@ class Pin : public QGraphicsItem, public ePin, public Updatable
 
         pinType_t  m_pinType;
         pinState_t m_pinState;
+        pinState_t m_paintState; // Front buffer of m_pinState
 
         int m_angle;
         int m_length;
@@ -13,6 +13,13 @@ class Updatable
         ~Updatable();
 
         virtual void updateStep(){;}
+
+        virtual void takeSnapshot(){;} // Copy simulation state to front buffer, called with simulation stopped
+
+        bool hasSnapshot() { return m_snapshot; }
+
+    protected:
+        bool m_snapshot; // updateStep() only reads front buffer: runs in parallel with simulation
 };
 
 #endif
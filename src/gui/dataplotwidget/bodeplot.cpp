@@ -0,0 +1,218 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPen>
+#include <cmath>
+
+#include "bodeplot.h"
+#include "acanalysis.h"
+#include "mainwindow.h"
+
+BodePlot::BodePlot( QWidget* parent )
+        : QWidget( parent )
+{
+    m_magMax = 0;
+    m_magMin = -60;
+    m_logStart = 1;
+    m_logEnd   = 6;
+    m_ceroX = 0;
+    m_endX  = 0;
+    m_cursorX = -1;
+
+    m_fontS.setFamily( MainWindow::self()->defaultFontName() );
+    m_fontS.setPixelSize( 11*MainWindow::self()->fontScale() );
+
+    m_color[0] = QColor( 240, 240, 100 ); // Same as Oscope channels
+    m_color[1] = QColor( 220, 220, 255 );
+    m_color[2] = QColor( 255, 210, 90  );
+    m_color[3] = QColor( 000, 245, 160 );
+    m_color[4] = QColor( 255, 255, 255 );
+
+    m_scaleColor[0] = QColor( 70, 70, 70 );
+    m_scaleColor[1] = QColor( 100, 100, 100 );
+    m_scaleColor[2] = QColor( 200, 200, 200 );
+
+    setMinimumSize( 400, 300 );
+    setMouseTracking( true );
+}
+BodePlot::~BodePlot(){}
+
+void BodePlot::clear()
+{
+    m_freqs.clear();
+    m_mag.clear();
+    m_phase.clear();
+    m_names.clear();
+    update();
+}
+
+void BodePlot::setData( AcAnalysis* ac )
+{
+    clear();
+    m_freqs = ac->freqs();
+    if( m_freqs.empty() ) return;
+
+    m_magMax = -1e12;
+    m_magMin =  1e12;
+    for( int p=0; p<ac->probes(); ++p )
+    {
+        m_names.append( ac->probeName( p ) );
+        std::vector<double> mag;
+        std::vector<double> phase;
+        for( const std::complex<double>& v : ac->response( p ) )
+        {
+            double dB = AcAnalysis::magnitudeDb( v );
+            mag.push_back( dB );
+            phase.push_back( AcAnalysis::phaseDeg( v ) );
+
+            if( std::isnan( dB ) || dB <= -300 ) continue; // Not solved or not connected
+            if( dB > m_magMax ) m_magMax = dB;
+            if( dB < m_magMin ) m_magMin = dB;
+        }
+        m_mag.push_back( mag );
+        m_phase.push_back( phase );
+    }
+    if( m_magMax < m_magMin ) { m_magMax = 0; m_magMin = -60; } // No valid data
+
+    m_magMax = 20*ceil( m_magMax/20+1e-9 );  // Round to 20 dB
+    m_magMin = 20*floor( m_magMin/20-1e-9 );
+    if( m_magMin < m_magMax-200 ) m_magMin = m_magMax-200;
+
+    m_logStart = floor( log10( m_freqs.front() )+1e-9 ); // Full decades
+    m_logEnd   = ceil(  log10( m_freqs.back() )-1e-9 );
+    if( m_logEnd <= m_logStart ) m_logEnd = m_logStart+1;
+
+    update();
+}
+
+double BodePlot::freqToX( double freq )
+{
+    return m_ceroX+(log10( freq )-m_logStart)*(m_endX-m_ceroX)/(m_logEnd-m_logStart);
+}
+
+void BodePlot::drawGrid( QPainter* p, double top, double bottom, double max, double min, double tick, QString unit )
+{
+    QPen pen( m_scaleColor[0], 1, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin );
+    QPen penText( m_scaleColor[2], 1 );
+    p->setFont( m_fontS );
+
+    for( double val=min; val<=max+1e-9; val+=tick ) // Horizontal lines
+    {
+        double y = bottom-(val-min)*(bottom-top)/(max-min);
+        p->setPen( pen );
+        p->drawLine( QPointF( m_ceroX, y ), QPointF( m_endX, y ) );
+        p->setPen( penText );
+        p->drawText( QRectF( 0, y-8, m_ceroX-4, 16 ), Qt::AlignRight | Qt::AlignVCenter, QString::number( val )+unit );
+    }
+    for( double dec=m_logStart; dec<m_logEnd+1e-9; dec+=1 ) // Vertical lines: decades and 2..9
+    {
+        for( int m=1; m<10; ++m )
+        {
+            double logF = dec+log10( (double)m );
+            if( logF > m_logEnd+1e-9 ) break;
+            double x = freqToX( pow( 10, logF ) );
+            p->setPen( QPen( m_scaleColor[ (m == 1) ? 1 : 0 ], (m == 1) ? 1.5 : 0.5 ) );
+            p->drawLine( QPointF( x, top ), QPointF( x, bottom ) );
+}   }   }
+
+void BodePlot::drawTrace( QPainter* p, const std::vector<double>& data, double top, double bottom, double max, double min )
+{
+    bool last = false;
+    double lastVal = 0;
+    QPointF lastP;
+    for( uint i=0; i<m_freqs.size(); ++i )
+    {
+        double val = data[i];
+        if( std::isnan( val ) || val <= -300 ) { last = false; continue; }
+        if( val > max ) val = max;
+        if( val < min ) val = min;
+
+        QPointF point( freqToX( m_freqs[i] ), bottom-(val-min)*(bottom-top)/(max-min) );
+        if( last && fabs( val-lastVal ) < (max-min)/2 ) p->drawLine( lastP, point ); // Not at phase wrap
+        lastP = point;
+        lastVal = val;
+        last = true;
+}   }
+
+void BodePlot::paintEvent( QPaintEvent* /* event */ )
+{
+    QPainter p( this );
+    p.setRenderHint( QPainter::Antialiasing, true );
+    p.setBrush( QColor( 0, 0, 0 ) );
+    p.drawRoundedRect( 0, 0, width(), height(), 7, 7 );
+
+    double margin = 10;
+    m_ceroX = 60;
+    m_endX  = width()-margin;
+
+    double legendH = 18;
+    double trackH = (height()-3*margin-legendH-16)/2;  // 16: frequency labels
+    double magTop = margin;
+    double magBot = magTop+trackH;
+    double phTop  = magBot+margin+16;
+    double phBot  = phTop+trackH;
+
+    double magTick = (m_magMax-m_magMin > 100) ? 40 : 20;
+    if( m_magMax-m_magMin <= 40 ) magTick = 10;
+    drawGrid( &p, magTop, magBot, m_magMax, m_magMin, magTick, " dB" );
+    drawGrid( &p, phTop, phBot, 180, -180, 90, "°" );
+
+    p.setPen( QPen( m_scaleColor[2], 1 ) );  // Frequency labels
+    for( double dec=m_logStart; dec<m_logEnd+1e-9; dec+=1 )
+    {
+        double freq = pow( 10, dec );
+        double x = freqToX( freq );
+        QString label;
+        if     ( freq >= 1e9 ) label = QString::number( freq/1e9 )+" GHz";
+        else if( freq >= 1e6 ) label = QString::number( freq/1e6 )+" MHz";
+        else if( freq >= 1e3 ) label = QString::number( freq/1e3 )+" kHz";
+        else                   label = QString::number( freq )+" Hz";
+        p.drawText( QRectF( x-40, magBot+2, 80, 16 ), Qt::AlignCenter, label );
+    }
+    for( int i=0; i<m_names.size(); ++i )  // Traces and legend
+    {
+        QPen pen( m_color[i%5], 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin );
+        if( i >= 5 ) pen.setStyle( Qt::DashLine );
+        p.setPen( pen );
+        drawTrace( &p, m_mag[i], magTop, magBot, m_magMax, m_magMin );
+        drawTrace( &p, m_phase[i], phTop, phBot, 180, -180 );
+
+        double x = m_ceroX+i*120;
+        double y = height()-margin-legendH/2;
+        p.drawLine( QPointF( x, y ), QPointF( x+16, y ) );
+        p.drawText( QRectF( x+20, y-8, 100, 16 ), Qt::AlignLeft | Qt::AlignVCenter, m_names.at( i ) );
+    }
+    if( m_cursorX < m_ceroX || m_cursorX > m_endX || m_freqs.empty() ) return;
+
+    double logF = m_logStart+(m_cursorX-m_ceroX)*(m_logEnd-m_logStart)/(m_endX-m_ceroX);
+    double freq = pow( 10, logF );
+    uint index = 0;                          // Nearest frequency point
+    while( index+1 < m_freqs.size() && m_freqs[index+1] <= freq ) index++;
+    if( index+1 < m_freqs.size() && freq/m_freqs[index] > m_freqs[index+1]/freq ) index++;
+
+    double x = freqToX( m_freqs[index] );
+    p.setPen( QPen( m_scaleColor[2], 1, Qt::DotLine ) );
+    p.drawLine( QPointF( x, magTop ), QPointF( x, phBot ) );
+
+    QString text = QString::number( m_freqs[index], 'g', 4 )+" Hz";
+    for( int i=0; i<m_names.size(); ++i )
+        text += "   "+m_names.at( i )+": "+QString::number( m_mag[i][index], 'f', 2 )+" dB "
+                                          +QString::number( m_phase[i][index], 'f', 1 )+"°";
+    p.drawText( QRectF( m_ceroX+4, magTop, m_endX-m_ceroX-8, 16 ), Qt::AlignLeft | Qt::AlignVCenter, text );
+}
+
+void BodePlot::mouseMoveEvent( QMouseEvent* event )
+{
+    m_cursorX = event->pos().x();
+    update();
+}
+
+void BodePlot::leaveEvent( QEvent* event )
+{
+    m_cursorX = -1;
+    update();
+}
@@ -0,0 +1,58 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef BODEPLOT_H
+#define BODEPLOT_H
+
+#include <QWidget>
+#include <QStringList>
+#include <vector>
+
+class AcAnalysis;
+
+// Magnitude (dB) and phase (degrees) against logarithmic frequency axis
+
+class BodePlot : public QWidget
+{
+    Q_OBJECT
+
+    public:
+        BodePlot( QWidget* parent=0 );
+        ~BodePlot();
+
+        void setData( AcAnalysis* ac );
+        void clear();
+
+    protected:
+        virtual void paintEvent( QPaintEvent* event ) override;
+        virtual void mouseMoveEvent( QMouseEvent* event ) override;
+        virtual void leaveEvent( QEvent* event ) override;
+
+    private:
+        inline double freqToX( double freq );
+        inline void drawGrid( QPainter* p, double top, double bottom, double max, double min, double tick, QString unit );
+        inline void drawTrace( QPainter* p, const std::vector<double>& data, double top, double bottom, double max, double min );
+
+        std::vector<double> m_freqs;
+        std::vector<std::vector<double>> m_mag;   // dB for each probe
+        std::vector<std::vector<double>> m_phase; // Degrees for each probe
+        QStringList m_names;
+
+        double m_magMax;
+        double m_magMin;
+        double m_logStart;
+        double m_logEnd;
+
+        double m_ceroX;
+        double m_endX;
+
+        int m_cursorX;
+
+        QFont m_fontS;
+        QColor m_color[5];
+        QColor m_scaleColor[3];
+};
+
+#endif
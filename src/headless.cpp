@@ -0,0 +1,236 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QRegExp>
+#include <QThread>
+#include <QFile>
+
+#include "headless.h"
+#include "sweep.h"
+#include "circuit.h"
+#include "simulator.h"
+#include "stimulus.h"
+#include "utils.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+static double peakRssMB() // Peak memory used by this process, 0 if unknown
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 ) return 0;
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss/1048576.0; // bytes
+#else
+    return usage.ru_maxrss/1024.0;    // KB
+#endif
+#else
+    return 0;
+#endif
+}
+
+uint64_t timeToPs( QString time, bool* ok ) // "2s", "500ms", "10 us"... to picoseconds
+{
+    QRegExp rx("^([0-9]*\\.?[0-9]+(?:[eE][-+]?[0-9]+)?)\\s*([pnum]?)s?$");
+    *ok = rx.exactMatch( time.trimmed() );
+    if( !*ok ) return 0;
+
+    double seconds = rx.cap(1).toDouble();
+    QString mult = rx.cap(2);
+    if( mult == "u" ) mult = "µ";
+    if( !mult.isEmpty() ) seconds *= getMultiplier( mult );
+    return seconds*1e12+0.5;
+}
+
+static void usage( QTextStream &out )
+{
+    out << "Usage: simulide --headless circuit.sim1 [--time 2s] [--max-speed] [--load-state file] [--save-state file] [--replay file] [--json]\n"
+        << "       simulide --headless circuit.sim1 --sweep spec.xml [--out results.csv] [--jobs N]\n"
+        << "  --time       Simulation time, units: ps, ns, us, ms, s (default 1s)\n"
+        << "  --max-speed  Run as fast as possible, ignore circuit speed setting\n"
+        << "  --load-state Start from a checkpoint saved with --save-state\n"
+        << "  --save-state Save a checkpoint at the end of the run\n"
+        << "  --replay     Feed inputs recorded in a .stim file at the same simulation times\n"
+        << "  --json       Print results as a JSON object\n"
+        << "  --sweep      Run circuit variants from a parameter sweep file (see sweep.h)\n"
+        << "  --out        Sweep results CSV file (default stdout)\n"
+        << "  --jobs       Sweep variants running in parallel (default number of cores)\n";
+}
+
+bool isHeadless( int argc, char* argv[] )
+{
+    for( int i=1; i<argc; ++i ) if( QString( argv[i] ) == "--headless" ) return true;
+    return false;
+}
+
+int runHeadless( QStringList args )
+{
+    QTextStream out( stdout );
+
+    QString circFile;
+    QString loadFile;
+    QString saveFile;
+    QString replayFile;
+    QString sweepFile;
+    QString outFile;
+    int jobs = QThread::idealThreadCount();
+    uint64_t simTime = 1e12;
+    bool maxSpeed = false;
+    bool json = false;
+
+    for( int i=1; i<args.size(); ++i )
+    {
+        QString arg = args.at(i);
+        if     ( arg == "--headless" ) continue;
+        else if( arg == "--max-speed" ) maxSpeed = true;
+        else if( arg == "--json"      ) json = true;
+        else if( arg == "--load-state" && i+1 < args.size() ) loadFile = args.at( ++i );
+        else if( arg == "--save-state" && i+1 < args.size() ) saveFile = args.at( ++i );
+        else if( arg == "--replay"     && i+1 < args.size() ) replayFile = args.at( ++i );
+        else if( arg == "--sweep"      && i+1 < args.size() ) sweepFile = args.at( ++i );
+        else if( arg == "--out"        && i+1 < args.size() ) outFile = args.at( ++i );
+        else if( arg == "--jobs"       && i+1 < args.size() ) jobs = args.at( ++i ).toInt();
+        else if( arg == "--time" && i+1 < args.size() )
+        {
+            bool ok;
+            simTime = timeToPs( args.at( ++i ), &ok );
+            if( !ok || simTime == 0 )
+            {
+                out << "Error: wrong simulation time: " << args.at(i) << "\n";
+                usage( out );
+                return 1;
+        }   }
+        else if( !arg.startsWith("--") && circFile.isEmpty() ) circFile = arg;
+        else{
+            out << "Error: unknown argument: " << arg << "\n";
+            usage( out );
+            return 1;
+    }   }
+    if( circFile.isEmpty() ) { usage( out ); return 1; }
+
+    if( !QFile::exists( circFile ) )
+    {
+        out << "Error: file not found: " << circFile << "\n";
+        return 1;
+    }
+    Circuit::self()->loadCircuit( circFile );
+    if( Circuit::self()->compList()->isEmpty() )
+    {
+        out << "Error: could not load circuit: " << circFile << "\n";
+        return 1;
+    }
+    if( !sweepFile.isEmpty() ) return runSweep( circFile, sweepFile, outFile, jobs );
+
+    if( !replayFile.isEmpty() && !QFile::exists( replayFile ) )
+    {
+        out << "Error: file not found: " << replayFile << "\n";
+        return 1;
+    }
+    Simulator* sim = Simulator::self();
+    Stimulus::self()->setRecord( false );        // Don't overwrite recordings from GUI runs
+    Stimulus::self()->setReplayFile( replayFile );
+
+    QElapsedTimer timer;
+    timer.start();
+    if( !sim->runHeadless( simTime, maxSpeed, loadFile ) )
+    {
+        sim->stopSim();
+        out << "Error: could not load state: " << loadFile << "\n";
+        return 1;
+    }
+    double wallSec = timer.nsecsElapsed()/1e9;
+
+    if( !saveFile.isEmpty() && !sim->saveStateFile( saveFile ) )
+        out << "Error: could not save state: " << saveFile << "\n";
+
+    uint64_t circTime = sim->circTime()-1;  // Simulation starts at 1 ps
+    int error   = sim->error();
+    int warning = sim->warning();
+    QString errorText   = sim->errorText();
+    QString warningText = sim->warningText();
+
+    simStats_t stats = sim->stats();
+    double   peakRss = peakRssMB();
+
+    sim->stopSim();
+
+    if( json )
+    {
+        QJsonObject result;
+        result["circuit"]          = circFile;
+        result["sim_time_ps"]      = (double)circTime;
+        result["wall_s"]           = wallSec;
+        result["ps_per_s"]         = circTime/wallSec;
+        result["events"]           = (double)stats.events;
+        result["events_per_s"]     = stats.events/wallSec;
+        result["events_cancelled"] = (double)stats.cancelled;
+        result["peak_queue"]       = (double)stats.peakQueue;
+        result["solves"]           = (double)stats.matrixSolves;
+        result["group_solves"]     = (double)stats.groupSolves;
+        result["factorizations"]   = (double)stats.factorizations;
+        result["factors_per_s"]    = stats.factorizations/wallSec;
+        result["nl_iterations"]    = (double)stats.nlIterations;
+        result["volt_changed"]     = (double)stats.voltChanged;
+        result["volt_sets"]        = (double)stats.voltSets;
+        result["peak_rss_mb"]      = peakRss;
+        result["warning"]          = (warning > 0) ? warningText : "";
+        result["error"]            = error ? errorText : "";
+        out << QJsonDocument( result ).toJson();
+        return error ? 2 : 0;
+    }
+    out << "Circuit:              " << circFile << "\n"
+        << "Simulated time:       " << circTime/1e12 << " s\n"
+        << "Wall time:            " << wallSec << " s\n"
+        << "Speed:                " << circTime/wallSec << " ps/s ("
+                                    << 100*circTime/wallSec/1e12 << " % of real time)\n"
+        << "Events:               " << stats.events << "\n"
+        << "  Cancelled:          " << stats.cancelled << "\n"
+        << "  Peak queue:         " << stats.peakQueue << "\n"
+        << "Matrix solves:        " << stats.matrixSolves << "\n"
+        << "  Group solves:       " << stats.groupSolves << "\n"
+        << "Factorizations:       " << stats.factorizations << "\n"
+        << "NonLinear iterations: " << stats.nlIterations << "\n"
+        << "voltChanged calls:    " << stats.voltChanged << "\n"
+        << "setVolt changes:      " << stats.voltSets << "\n"
+        << "Peak memory:          " << peakRss << " MB\n";
+
+    if( warning > 0 ) out << "Warning: " << warningText << "\n";
+    if( error )
+    {
+        out << "Error: " << errorText << "\n";
+        return 2;
+    }
+    return 0;
+}
+
+int runSweep( QString circFile, QString sweepFile, QString outFile, int jobs )
+{
+    QTextStream out( outFile.isEmpty() ? stderr : stdout ); // Results can go to stdout
+
+    Sweep sweep;
+    if( !sweep.loadSpec( sweepFile ) )
+    {
+        out << "Error: wrong sweep file: " << sweepFile << "\n";
+        return 1;
+    }
+    out << "Sweep: " << sweep.variants() << " variants, " << sweep.simTime()/1e12 << " s each\n";
+    out.flush();
+
+    QElapsedTimer timer;
+    timer.start();
+    if( !sweep.run( circFile, jobs ) ) return 1;
+    double wallSec = timer.nsecsElapsed()/1e9;
+
+    out << "Wall time: " << wallSec << " s\n";
+    out.flush();
+    if( !sweep.writeResults( outFile ) ) return 1;
+    return 0;
+}
@@ -0,0 +1,24 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QStringList>
+#include <stdint.h>
+
+// Command line runner, no windows shown and no frame pacing:
+// simulide --headless circuit.sim1 [--time 2s] [--max-speed] [--load-state file] [--save-state file] [--replay file] [--json]
+// simulide --headless circuit.sim1 --sweep spec.xml [--out results.csv] [--jobs N]
+// Prints timing statistics to stdout, as JSON with --json.
+// Returns 0 if Ok, 1 if wrong arguments or circuit, 2 if simulation error.
+
+bool isHeadless( int argc, char* argv[] );
+int  runHeadless( QStringList args );
+int  runSweep( QString circFile, QString sweepFile, QString outFile, int jobs );
+
+uint64_t timeToPs( QString time, bool* ok ); // "2s", "500ms", "10 us"... to picoseconds
+
+#endif
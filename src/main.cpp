@@ -10,6 +10,7 @@
 
 #include "mainwindow.h"
 #include "circuitwidget.h"
+#include "headless.h"
 
 void myMessageOutput( QtMsgType type, const QMessageLogContext &context, const QString &msg )
 {
@@ -50,6 +51,10 @@ int main( int argc, char *argv[] )
 {
     qInstallMessageHandler( myMessageOutput );
 
+    bool headless = isHeadless( argc, argv );
+    if( headless && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM") )
+        qputenv("QT_QPA_PLATFORM", "offscreen"); // No display needed
+
     QApplication app( argc, argv );
 
     QSettings settings( QStandardPaths::standardLocations( QStandardPaths::DataLocation).first()+"/simulide.ini",  QSettings::IniFormat, 0l );
@@ -73,6 +78,10 @@ int main( int argc, char *argv[] )
     MainWindow window;
     window.setLoc( locale );
 
+    if( headless ) return runHeadless( app.arguments() ); // Window is never shown
+
+    window.loadBackup();
+
     if( argc > 1 )
     {
         QString circ = QString::fromStdString( argv[1] );
@@ -90,8 +90,11 @@ MainWindow::MainWindow()
     if( !m_userDir.isEmpty() ) m_fileSystemTree->addEntry( tr("User Data"), m_userDir );
 
     readSettings();
+}
+MainWindow::~MainWindow(){ }
 
-
+void MainWindow::loadBackup() // Ask to open the auto-saved circuit if SimulIDE crashed
+{
     QString backPath = getConfigPath( "backup.sim1" );
     if( QFile::exists( backPath ) )
     {
@@ -108,7 +111,6 @@ MainWindow::MainWindow()
         else QFile::remove( backPath ); // Remove backup file
     }
 }
-MainWindow::~MainWindow(){ }
 
 void MainWindow::closeEvent( QCloseEvent *event )
 {
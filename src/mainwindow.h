@@ -48,6 +48,7 @@ class MainWindow : public QMainWindow
         QSettings* compSettings();
         
         void readSettings();
+        void loadBackup();
         
         void setFile( QString file );
         void setState( QString state );
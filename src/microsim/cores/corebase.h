@@ -10,6 +10,7 @@
 #include <QHash>
 
 class Display;
+class QDataStream;
 
 class CoreBase
 {
@@ -24,6 +25,9 @@ class CoreBase
 
         virtual void command( QString c ){;}
 
+        virtual bool saveState( QDataStream& out ){ return false; } // Registers not in Ram, for Simulator checkpoints
+        virtual void loadState( QDataStream& in ){;}
+
         virtual int getCpuReg( QString reg );
         virtual QString getStrReg( QString ){ return "";}
 
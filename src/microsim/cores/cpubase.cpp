@@ -3,6 +3,8 @@
  *                                                                         *
  ***( see copyright.txt file at root folder )*******************************/
 
+#include <QDataStream>
+
 #include "cpubase.h"
 
 CpuBase::CpuBase( eMcu* mcu )
@@ -18,6 +20,20 @@ CpuBase::CpuBase( eMcu* mcu )
 }
 CpuBase::~CpuBase() {}
 
+bool CpuBase::saveState( QDataStream& out ) // Only PC: registers out of Ram are not saved
+{
+    out << (quint32)m_PC << (quint32)m_RET_ADDR;
+    return false;
+}
+
+void CpuBase::loadState( QDataStream& in )
+{
+    quint32 pc, retAddr;
+    in >> pc >> retAddr;
+    m_PC = pc;
+    m_RET_ADDR = retAddr;
+}
+
 void CpuBase::reset()
 {
     m_PC = 0;
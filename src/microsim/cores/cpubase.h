@@ -23,6 +23,9 @@ class CpuBase : public CoreBase
 
         virtual void reset() override;
 
+        virtual bool saveState( QDataStream& out ) override;
+        virtual void loadState( QDataStream& in ) override;
+
         uint8_t* getStatus() { return m_STATUS; }  // Used my Monitor: All CPUs must use m_STATUS
 
         virtual void INTERRUPT( uint32_t vector ) { CALL_ADDR( vector ); }
@@ -58,11 +58,11 @@ void I51Core::reset()
 
     m_enPin->setPinMode( output );
     m_enPin->setOutState( true );
-    m_enPin->updateStep();
+    m_enPin->takeSnapshot();
 
     m_laPin->setPinMode( output );
     m_laPin->setOutState( false );
-    m_laPin->updateStep();
+    m_laPin->takeSnapshot();
 
     m_psStep = m_mcu->psInst()/12;  // We are doing 2 Read cycles per Machine cycle
     m_addrSetTime = 3*m_psStep;    // Addr pins
@@ -63,6 +63,8 @@ class I51Core : public McuCpu, public eElement
 
         virtual void INTERRUPT( uint32_t addr ) override;
 
+        virtual bool saveState( QDataStream& out ) override { McuCpu::saveState( out ); return false; } // Cycle state not saved
+
     protected:
 
         uint64_t m_psStep;  // Half Clock cycle ps = 1/24 Machine cycle, = 1/12 Read cycle.
@@ -17,6 +17,8 @@ class McuCpu : public CpuBase
 
         virtual void CALL_ADDR( uint32_t addr ) override; // Used by MCU Interrupts:: All MCUs should use or override this
 
+        virtual bool saveState( QDataStream& out ) override { CpuBase::saveState( out ); return true; } // Registers are in Mcu Ram
+
     protected:
         uint8_t*  m_dataMem;
         uint32_t  m_dataMemEnd;
@@ -29,6 +29,8 @@ class ScriptCpu : public ScriptBase, public McuCpu
         virtual void extClock( bool clkState ) override;
         virtual void updateStep() override;
 
+        virtual bool saveState( QDataStream& out ) override { McuCpu::saveState( out ); return false; } // Script variables not saved
+
         void setPeriferals( std::vector<ScriptPerif*> p);
         virtual void setScriptFile( QString scriptFile, bool compile=true ) override;
         virtual int compileScript() override;
@@ -3,6 +3,8 @@
  *                                                                         *
  ***( see copyright.txt file at root folder )*******************************/
 
+#include <QDataStream>
+
 #include "e_mcu.h"
 #include "mcu.h"
 #include "cpubase.h"
@@ -85,6 +87,46 @@ void eMcu::voltChanged()  // External clock
     }
 }
 
+bool eMcu::saveState( QDataStream& out ) // Ram, Flash, Eeprom and Cpu registers
+{
+    out << (qint32)m_state << (quint64)m_cycle << (qint32)cyclesDone << m_clkState;
+    out << QByteArray( (const char*)m_dataMem.data(), m_dataMem.size() );
+
+    out << (quint32)m_progMem.size();
+    for( uint16_t word : m_progMem ) out << (quint16)word;
+    out << m_eeprom;
+
+    bool saved = m_interrupts.idle();          // Pending Interrupts are not saved
+    if( m_cpu && !m_cpu->saveState( out ) ) saved = false;
+    return saved;
+}
+
+void eMcu::loadState( QDataStream& in )
+{
+    qint32 state, done;
+    quint64 cycle;
+    in >> state >> cycle >> done >> m_clkState;
+    m_state = (mcuState_t)state;
+    m_cycle = cycle;
+    cyclesDone = done;
+
+    QByteArray ram;
+    in >> ram;
+    if( ram.size() == (int)m_dataMem.size() ) memcpy( m_dataMem.data(), ram.constData(), ram.size() );
+
+    quint32 flashSize;
+    in >> flashSize;
+    for( quint32 i=0; i<flashSize; ++i )
+    {
+        quint16 word;
+        in >> word;
+        if( i < m_progMem.size() ) m_progMem[i] = word;
+    }
+    in >> m_eeprom;
+
+    if( m_cpu ) m_cpu->loadState( in );
+}
+
 void eMcu::runEvent()
 {
     if( m_state != mcuRunning ) return;
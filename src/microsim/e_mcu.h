@@ -56,6 +56,9 @@ class eMcu : public DataSpace, public eIou
         virtual void voltChanged() override;
         virtual void runEvent() override;
 
+        virtual bool saveState( QDataStream& out ) override;
+        virtual void loadState( QDataStream& in ) override;
+
         inline mcuState_t state() { return m_state; }
         inline int sleepMode() { return m_sleepModule->mode(); }
 
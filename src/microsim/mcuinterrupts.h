@@ -97,6 +97,8 @@ class Interrupts
         void resetInts();
         void writeGlobalFlag( uint8_t flag );
 
+        bool idle() { return !m_active && !m_pending && !m_running; } // No Interrupt state to save
+
         void addToPending( Interrupt* newInt );
         void remFromPending( Interrupt* remInt );
 
@@ -3,6 +3,8 @@
  *                                                                         *
  ***( see copyright.txt file at root folder )*******************************/
 
+#include <QDataStream>
+
 #include "mcutimer.h"
 #include "e_mcu.h"
 #include "mcupin.h"
@@ -53,6 +55,36 @@ void McuTimer::initialize()
     m_scale = m_prescaler*m_mcu->psInst();
 }
 
+bool McuTimer::saveState( QDataStream& out ) // Count registers are saved in Mcu Ram
+{
+    out << (quint64)m_scale << m_running << m_bidirec << m_reverse << m_extClock
+        << (quint32)m_countVal << (quint32)m_countStart << (quint16)m_maxCount << (quint16)m_ovfMatch
+        << (quint32)m_ovfPeriod << (quint64)m_ovfCycle << (quint8)m_mode << (quint16)m_prescaler
+        << m_clkState << m_sleeping;
+    return true;
+}
+
+void McuTimer::loadState( QDataStream& in )
+{
+    quint64 scale, ovfCycle;
+    quint32 countVal, countStart, ovfPeriod;
+    quint16 maxCount, ovfMatch, prescaler;
+    quint8  mode;
+    in >> scale >> m_running >> m_bidirec >> m_reverse >> m_extClock
+       >> countVal >> countStart >> maxCount >> ovfMatch
+       >> ovfPeriod >> ovfCycle >> mode >> prescaler
+       >> m_clkState >> m_sleeping;
+    m_scale      = scale;
+    m_countVal   = countVal;
+    m_countStart = countStart;
+    m_maxCount   = maxCount;
+    m_ovfMatch   = ovfMatch;
+    m_ovfPeriod  = ovfPeriod;
+    m_ovfCycle   = ovfCycle;
+    m_mode       = mode;
+    m_prescaler  = prescaler;
+}
+
 void McuTimer::voltChanged()  // External Clock Pin changed voltage
 {
     bool state = m_clockPin->getInpState();
@@ -31,6 +31,9 @@ class McuTimer : public McuPrescaled, public eElement
         virtual void runEvent() override;
         virtual void voltChanged() override;
 
+        virtual bool saveState( QDataStream& out ) override;
+        virtual void loadState( QDataStream& in ) override;
+
         virtual void sleep( int mode ) override;
 
         virtual void resetTimer();
@@ -0,0 +1,238 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <QTextStream>
+#include <QFile>
+#include <QDebug>
+#include <cmath>
+
+#include "acanalysis.h"
+#include "simulator.h"
+#include "circmatrix.h"
+#include "circuit.h"
+#include "e-element.h"
+#include "e-node.h"
+#include "pin.h"
+
+AcAnalysis::AcAnalysis()
+{
+    m_fStart = 10;
+    m_fStop  = 1e6;
+    m_pointsPerDec = 20;
+    m_size = 0;
+    m_sourceIndex = -1;
+}
+AcAnalysis::~AcAnalysis(){}
+
+void AcAnalysis::addProbe( QString name, QString pinId )
+{
+    m_probeNames.append( name );
+    m_probePins.append( pinId );
+}
+
+void AcAnalysis::clearProbes()
+{
+    m_probeNames.clear();
+    m_probePins.clear();
+}
+
+void AcAnalysis::setSweep( double fStart, double fStop, int pointsPerDec )
+{
+    m_fStart = fStart;
+    m_fStop  = fStop;
+    m_pointsPerDec = pointsPerDec;
+}
+
+bool AcAnalysis::run()
+{
+    m_error.clear();
+    m_freqs.clear();
+    m_response.clear();
+
+    if( m_fStart <= 0 || m_fStop <= m_fStart || m_pointsPerDec < 1 )
+    { m_error = "Wrong frequency range"; return false; }
+
+    Simulator* sim = Simulator::self();
+    if( !sim->isRunning() )
+    { m_error = "Simulation not running: AC analysis uses current circuit state"; return false; }
+
+    sim->holdCircuit();   // Circuit state can't change while we read it
+
+    bool ok = createMatrix();
+    if( ok )
+    {
+        int points = std::lround( log10( m_fStop/m_fStart )*m_pointsPerDec )+1;
+        if( points < 2 ) points = 2;
+
+        m_response.assign( m_probeNames.size(), std::vector<complex_t>() );
+        std::vector<complex_t> x( m_size );
+
+        for( int i=0; i<points; ++i )  // Logarithmic frequency grid
+        {
+            double freq = m_fStart*pow( m_fStop/m_fStart, (double)i/(points-1) );
+            bool solved = solveFreq( freq, x );
+
+            m_freqs.push_back( freq );
+            for( int p=0; p<m_probeNames.size(); ++p )
+            {
+                if( solved ) m_response[p].push_back( x[m_probeIndex[p]] );
+                else         m_response[p].push_back( complex_t( NAN, NAN ) );
+    }   }   }
+    sim->releaseCircuit();
+    return ok;
+}
+
+bool AcAnalysis::createMatrix() // Admitance matrix of source group as stamped at current state
+{
+    m_nodeIndex.clear();
+    m_probeIndex.clear();
+
+    Circuit* circuit = Circuit::self();
+    Pin* srcPin = circuit->getPin( m_source );
+    eNode* srcNode = srcPin ? srcPin->getEnode() : NULL;
+    if( !srcNode || srcNode->getNodeNumber() == 0 )
+    { m_error = "Source pin not found or not connected: "+m_source; return false; }
+
+    QList<eNode*> nodes;
+    int group = srcNode->nodeGroup();
+    if( group < 0 ) nodes.append( srcNode ); // Single eNode
+    else            nodes = Simulator::self()->matrix()->groupNodes( group );
+
+    m_size = nodes.size();
+    QHash<int, int> numIndex; // eNode number to index
+    for( int i=0; i<m_size; ++i )
+    {
+        m_nodeIndex[nodes.at(i)] = i;
+        numIndex[nodes.at(i)->getNodeNumber()] = i;
+    }
+    m_sourceIndex = m_nodeIndex.value( srcNode );
+
+    m_base.assign( m_size*m_size, complex_t() );
+    std::vector<int> conNodes;
+    std::vector<double> admits;
+    for( int i=0; i<m_size; ++i )  // Same values as eNode::stampMatrix()
+    {
+        eNode* node = nodes.at(i);
+        m_base[i*m_size+i] = node->totalAdmit();
+
+        node->nodeAdmitances( conNodes, admits );
+        for( uint k=0; k<conNodes.size(); ++k )
+        {
+            int j = numIndex.value( conNodes[k], -1 );
+            if( j >= 0 ) m_base[i*m_size+j] -= admits[k];
+    }   }
+
+    for( int p=0; p<m_probePins.size(); ++p )
+    {
+        QString pinId = m_probePins.at( p );
+        Pin* pin = circuit->getPin( pinId );
+        if( !pin ) { m_error = "Probe pin not found: "+pinId; return false; }
+
+        eNode* node = pin->getEnode();
+        int index = node ? m_nodeIndex.value( node, -1 ) : -1;
+        if( index < 0 )
+        { m_error = "Probe not linked to source (Op Amp or IoPin driven stage?): "+pinId; return false; }
+
+        m_probeIndex.push_back( index );
+    }
+    return true;
+}
+
+void AcAnalysis::addAdmit( eNode* a, eNode* b, complex_t y ) // Admitance y between eNodes a and b
+{
+    int i = a ? m_nodeIndex.value( a, -1 ) : -1;
+    int j = b ? m_nodeIndex.value( b, -1 ) : -1;
+
+    if( i >= 0 ) m_matrix[i*m_size+i] += y;
+    if( j >= 0 ) m_matrix[j*m_size+j] += y;
+    if( i >= 0 && j >= 0 )
+    {
+        m_matrix[i*m_size+j] -= y;
+        m_matrix[j*m_size+i] -= y;
+}   }
+
+bool AcAnalysis::solveFreq( double freq, std::vector<complex_t>& x )
+{
+    int n = m_size;
+    m_matrix = m_base;
+
+    double omega = 2*M_PI*freq;
+    for( eElement* el : Simulator::self()->elementList() ) el->stampAc( this, omega );
+
+    for( int j=0; j<n; ++j ) m_matrix[m_sourceIndex*n+j] = 0; // Source eNode: V = 1
+    m_matrix[m_sourceIndex*n+m_sourceIndex] = 1;
+    for( int i=0; i<n; ++i ) x[i] = 0;
+    x[m_sourceIndex] = 1;
+
+    complex_t* a = m_matrix.data();
+    for( int k=0; k<n; ++k )   // Gaussian elimination with partial pivoting
+    {
+        int pivot = k;
+        double max = std::abs( a[k*n+k] );
+        for( int i=k+1; i<n; ++i )
+        {
+            double val = std::abs( a[i*n+k] );
+            if( val > max ) { max = val; pivot = i; }
+        }
+        if( max < 1e-300 ) return false;
+
+        if( pivot != k )
+        {
+            for( int j=k; j<n; ++j ) std::swap( a[k*n+j], a[pivot*n+j] );
+            std::swap( x[k], x[pivot] );
+        }
+        complex_t inv = 1.0/a[k*n+k];
+        for( int i=k+1; i<n; ++i )
+        {
+            complex_t factor = a[i*n+k]*inv;
+            if( factor == 0.0 ) continue;
+            for( int j=k+1; j<n; ++j ) a[i*n+j] -= factor*a[k*n+j];
+            x[i] -= factor*x[k];
+    }   }
+    for( int i=n-1; i>=0; --i )
+    {
+        complex_t sum = x[i];
+        for( int j=i+1; j<n; ++j ) sum -= a[i*n+j]*x[j];
+        x[i] = sum/a[i*n+i];
+    }
+    return true;
+}
+
+double AcAnalysis::magnitudeDb( complex_t v )
+{
+    double mag = std::abs( v );
+    if( mag < 1e-15 ) mag = 1e-15; // -300 dB floor
+    return 20*log10( mag );
+}
+
+double AcAnalysis::phaseDeg( complex_t v )
+{
+    return std::arg( v )*180/M_PI;
+}
+
+bool AcAnalysis::writeCsv( QString fileName )
+{
+    QFile file( fileName );
+    if( !file.open( QFile::WriteOnly | QFile::Text ) )
+    { qDebug() << "Error: AcAnalysis::writeCsv: Cannot write file" << fileName; return false; }
+
+    QTextStream out( &file );
+    out << "Frequency (Hz)";
+    for( const QString& name : m_probeNames ) out << ",\"" << name << " (dB)\",\"" << name << " (deg)\"";
+    out << "\n";
+
+    for( uint i=0; i<m_freqs.size(); ++i )
+    {
+        out << QString::number( m_freqs[i], 'g', 10 );
+        for( const std::vector<complex_t>& response : m_response )
+        {
+            out << "," << QString::number( magnitudeDb( response[i] ), 'g', 8 )
+                << "," << QString::number( phaseDeg( response[i] ), 'g', 8 );
+        }
+        out << "\n";
+    }
+    file.close();
+    return true;
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef ACANALYSIS_H
+#define ACANALYSIS_H
+
+#include <complex>
+#include <vector>
+#include <QStringList>
+#include <QHash>
+
+class eNode;
+
+// AC small signal analysis:
+// The circuit is linearized around it's current state: the admitances stamped
+// in the matrix are used as they are (Non Linear elements stamp their conductance
+// at the operating point), and elements with frequency dependent admitance
+// (Capacitors, Inductors) replace their companion model in stampAc().
+// The source pin is driven with 1 V AC, so results are gains relative to the source.
+// Only the CircMatrix group of the source eNode is solved: probes outside it are an error.
+// Stages driven from voltChanged() (Op Amp outputs, IoPins...) have no admitance to
+// their inputs, so they are not linearized and their outputs are outside the group.
+// Transformer coupling is not included: coils keep their companion conductance.
+
+class AcAnalysis
+{
+    typedef std::complex<double> complex_t;
+
+    public:
+        AcAnalysis();
+        ~AcAnalysis();
+
+        void setSource( QString pinId ) { m_source = pinId; }
+        QString source() { return m_source; }
+
+        void addProbe( QString name, QString pinId ); // Probe components: "Probe-1-inpin"
+        void clearProbes();
+
+        void setSweep( double fStart, double fStop, int pointsPerDec );
+
+        bool run();  // Simulation must be running or paused, called from GUI thread
+
+        QString error() { return m_error; }
+
+        const std::vector<double>& freqs() { return m_freqs; }
+        int probes() { return m_probeNames.size(); }
+        QString probeName( int p ) { return m_probeNames.at( p ); }
+        const std::vector<complex_t>& response( int p ) { return m_response[p]; }
+
+        bool writeCsv( QString fileName );
+
+ static double magnitudeDb( complex_t v );
+ static double phaseDeg( complex_t v );
+
+        void addAdmit( eNode* a, eNode* b, complex_t y ); // Called from eElement::stampAc()
+
+    private:
+        bool createMatrix();
+        bool solveFreq( double freq, std::vector<complex_t>& x );
+
+        QString m_source;
+        QStringList m_probeNames;
+        QStringList m_probePins;
+
+        double m_fStart;
+        double m_fStop;
+        int    m_pointsPerDec;
+
+        int m_size;
+        int m_sourceIndex;
+        std::vector<int> m_probeIndex;   // Index of each probe eNode in source group
+
+        QHash<eNode*, int> m_nodeIndex;  // Index of each eNode of source group
+        std::vector<complex_t> m_base;   // Admitance matrix as stamped, row major
+        std::vector<complex_t> m_matrix; // Matrix at current frequency
+
+        std::vector<double> m_freqs;
+        std::vector<std::vector<complex_t>> m_response; // For each probe
+
+        QString m_error;
+};
+
+#endif
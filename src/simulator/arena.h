@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+
+// Pool of linked list items allocated in blocks.
+// Items released are kept in a free list and reused in next simulation runs,
+// so building eNode lists doesn't call new/delete for every link.
+// T must have a default constructor and a "T* next" member.
+// Blocks are freed with the Arena: items must not be used after that.
+
+template <class T>
+class Arena
+{
+    public:
+        Arena( int blockSize=256 ) { m_free = nullptr; m_blockSize = blockSize; }
+        ~Arena() { for( T* block : m_blocks ) delete[] block; }
+
+        inline T* get()
+        {
+            if( !m_free ) newBlock();
+            T* item = m_free;
+            m_free = item->next;
+            item->next = nullptr;
+            return item;
+        }
+
+        inline void put( T* item )
+        {
+            item->next = m_free;
+            m_free = item;
+        }
+
+        void putList( T* first ) // Release a full list
+        {
+            while( first ){
+                T* next = first->next;
+                put( first );
+                first = next;
+        }   }
+
+    private:
+        void newBlock()
+        {
+            T* block = new T[m_blockSize];
+            m_blocks.push_back( block );
+            for( int i=m_blockSize-1; i>=0; --i ) put( &block[i] ); // Keep block order
+        }
+
+        T*  m_free;
+        int m_blockSize;
+        std::vector<T*> m_blocks;
+};
+
+#endif
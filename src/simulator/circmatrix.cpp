@@ -4,224 +4,311 @@
  ***( see copyright.txt file at root folder )*******************************/
 
 #include <iostream>
+#include <qtconcurrentrun.h>
 #include <QtMath>
+#include <QDebug>
+#include <algorithm>
+#include <cstdint>
 //#include <iomanip> // setw()
 
 #include "circmatrix.h"
 #include "simulator.h"
+#include "mainwindow.h"
+#include "simdkernels.h"
 
-CircMatrix* CircMatrix::m_pSelf = 0l;
+thread_local CircMatrix* CircMatrix::m_pSelf = 0l;
 
 CircMatrix::CircMatrix()
 {
     m_pSelf = this;
     m_numEnodes = 0;
+    m_sparseMin = 100;
+    m_parallelMin = MainWindow::self()->settings()->value( "parallelMin", 50 ).toInt();
+    m_parallel    = MainWindow::self()->settings()->value( "parallelSolve", false ).toBool();
+    m_profiling = false;
+    m_profTimer.start();
+
+    int threads = QThread::idealThreadCount()-1; // Simulation thread also solves groups
+    if( threads < 1 ) threads = 1;
+    m_threadPool.setMaxThreadCount( threads );
+    m_threadPool.setExpiryTimeout( -1 );         // Keep workers alive
+
+    SimdKernels::initKernels();
+}
+CircMatrix::~CircMatrix()
+{
+    m_threadPool.waitForDone();
+    clearGroups();
 }
-CircMatrix::~CircMatrix(){}
 
 void CircMatrix::createMatrix( QList<eNode*> &eNodeList )
 {
     m_eNodeList = &eNodeList;
     m_numEnodes = eNodeList.size();
 
-    m_circMatrix.clear();
     m_coefVect.clear();
-
-    m_circMatrix.resize( m_numEnodes , d_vector_t( m_numEnodes , 0 ) );
     m_coefVect.resize( m_numEnodes , 0 );
 
+    m_nodeGroup.assign( m_numEnodes, -1 );
+    m_nodeIndex.assign( m_numEnodes, 0 );
+    m_diagonal.assign( m_numEnodes, NULL );
+    m_stampRow.assign( m_numEnodes, NULL );
+
     /// qDebug() <<"\n  Initializing Matrix: "<< m_numEnodes << " eNodes";
     analyze();
 }
 
-void CircMatrix::addConnections( int enodNum, QList<int>* nodeGroup, QList<int>* allNodes )
+void CircMatrix::clearGroups()
 {
-    nodeGroup->append( enodNum );
-    allNodes->removeOne( enodNum );
-
-    eNode* enod = m_eNodeList->at( enodNum-1 );
-    enod->setSingle( false );
-
-    QList<int> cons = enod->getConnections();
+    for( DenseLU*  dense  : m_denseList  ) delete dense;
+    for( SparseLU* sparse : m_sparseList ) delete sparse;
+    m_denseList.clear();
+    m_sparseList.clear();
+    m_bList.clear();
+    m_eNodeActList.clear();
+    m_xList.clear();
+}
 
-    for( int nodeNum : cons )
+static inline int findRoot( std::vector<int> &parent, int i ) // Union-find root with path halving
+{
+    while( parent[i] != i )
     {
-        if( nodeNum == 0 ) continue;
-        if( !nodeGroup->contains( nodeNum ) ) addConnections( nodeNum, nodeGroup, allNodes );
+        parent[i] = parent[ parent[i] ];
+        i = parent[i];
     }
+    return i;
 }
 
 void CircMatrix::analyze()
 {
-    QList<int> allNodes;
-    for( int i=0; i<m_numEnodes; i++ ) allNodes.append( i+1 );
-
-    m_aList.clear();
-    m_aFaList.clear();
-    m_bList.clear();
-    m_eNodeActList.clear();
+    clearGroups();
     int group = 0;
     int singleNode = 0;
+    int sparseGroups = 0;
 
-    while( !allNodes.isEmpty() ) // Get a list of groups of nodes interconnected
-    {
-        QList<int> nodeGroup;
-        addConnections( allNodes.first(), &nodeGroup, &allNodes ); // Get a group of nodes interconnected
+    std::vector<int> parent( m_numEnodes ); // Join interconnected nodes, root is the lowest one
+    for( int y=0; y<m_numEnodes; ++y ) parent[y] = y;
 
+    for( int y=0; y<m_numEnodes; ++y )
+    {
+        for( int nodeNum : m_eNodeList->at( y )->getConnections() )
+        {
+            if( nodeNum == 0 ) continue;
+            int a = findRoot( parent, y );
+            int b = findRoot( parent, nodeNum-1 );
+            if     ( a < b ) parent[b] = a;
+            else if( b < a ) parent[a] = b;
+    }   }
+    std::vector<std::vector<int>> groupList; // Groups of nodes interconnected, ordered by first node
+    std::vector<int> rootGroup( m_numEnodes, -1 );
+    for( int y=0; y<m_numEnodes; ++y )
+    {
+        int root = findRoot( parent, y );
+        if( rootGroup[root] < 0 )
+        {
+            rootGroup[root] = groupList.size();
+            groupList.emplace_back();
+        }
+        groupList[ rootGroup[root] ].push_back( y ); // Nodes in group ordered by eNode number
+    }
+    for( const std::vector<int>& nodeGroup : groupList )
+    {
         int numEnodes = nodeGroup.size();
         if( numEnodes==1 )           // Sigle nodes do by themselves
         {
-            eNode* enod = m_eNodeList->at( nodeGroup[0]-1 );
+            eNode* enod = m_eNodeList->at( nodeGroup[0] );
             enod->setSingle( true );
             singleNode++;
         }else{
-            dp_matrix_t a;
-            d_matrix_t ap;
             dp_vector_t b;
             QList<eNode*> eNodeActive;
 
-            a.resize( numEnodes , dp_vector_t( numEnodes , 0 ) );
-            ap.resize( numEnodes , d_vector_t( numEnodes , 0 ) );
             b.resize( numEnodes , 0 );
+            eNodeActive.reserve( numEnodes );
 
-            int ny=0;
-            for( int y=0; y<m_numEnodes; ++y )    // Copy data to reduced Matrix
+            for( int ny=0; ny<numEnodes; ++ny )
             {
-                if( !nodeGroup.contains( y+1 ) ) continue;
-                int nx=0;
-                for( int x=0; x<m_numEnodes; ++x )
-                {
-                    if( !nodeGroup.contains( x+1 ) ) continue;
-                    a[nx][ny] = &(m_circMatrix[x][y]);
-                    nx++;
-                }
+                int y = nodeGroup[ny];
+                m_nodeGroup[y] = group;
+                m_nodeIndex[y] = ny;
                 b[ny] = &(m_coefVect[y]);
                 eNode* node = m_eNodeList->at(y);
+                node->setSingle( false );
                 node->setNodeGroup( group );
                 eNodeActive.append( node );
-                ny++;
             }
-            m_aList.append( a );
-            m_aFaList.append( ap );
+            SparseLU* sparse = NULL;
+            if( numEnodes >= m_sparseMin )     // Big group: try sparse LU
+            {
+                std::vector<std::vector<int>> pattern( numEnodes );
+                for( int ny=0; ny<numEnodes; ++ny )
+                {
+                    for( int nodeNum : eNodeActive.at( ny )->getConnections() )
+                        if( nodeNum > 0 ) pattern[ny].push_back( m_nodeIndex[nodeNum-1] );
+                }
+                sparse = new SparseLU();
+                sparse->analyze( numEnodes, pattern );
+
+                if( sparse->nonZeros() > (int64_t)numEnodes*numEnodes/4 ) // Too much fill-in, dense is faster
+                {
+                    delete sparse;
+                    sparse = NULL;
+            }   }
+            DenseLU* dense = NULL;
+            if( sparse ) sparseGroups++;
+            else         dense = new DenseLU( numEnodes );
+            m_denseList.push_back( dense );
+            m_sparseList.push_back( sparse );
             m_bList.append( b );
             m_eNodeActList.append( eNodeActive );
+            m_xList.push_back( d_vector_t( numEnodes, 0 ) );
             group++;
         }
     }
-    m_admitChanged.resize( group, true );
-    m_currChanged.resize(  group, true );
+    for( int y=0; y<m_numEnodes; ++y ) // Diagonal and row of each eNode for stamping
+    {
+        int g = m_nodeGroup[y];
+        if( g < 0 ) continue;
+        int i = m_nodeIndex[y];
+        if( m_sparseList[g] ) m_diagonal[y] = m_sparseList[g]->diagonal( i );
+        else{
+            m_stampRow[y] = m_denseList[g]->row( i );
+            m_diagonal[y] = &(m_stampRow[y][i]);
+    }   }
+    m_solveOk.assign( group, 1 );
+    m_toSolve.reserve( group );
+
+    m_admitChanged.assign( group, true );
+    m_currChanged.assign(  group, true );
+    m_solveCount.assign( group, 0 );
+
+    clearProfile();
 
     /// qDebug() <<"CircMatrix::solveMatrix"<<group<<"Circuits";
+    /// qDebug() <<"CircMatrix::solveMatrix"<<sparseGroups<<"Sparse Circuits";
     /// qDebug() <<"CircMatrix::solveMatrix"<<singleNode<<"Single Nodes\n";
 }
 
 bool CircMatrix::solveMatrix()
 {
-    bool ok = true;
+    m_toSolve.clear();
+    int bigGroups = 0;
     for( int i=0; i<m_bList.size(); ++i )
     {
         if( !m_admitChanged[i] && !m_currChanged[i] ) continue;
+        m_toSolve.push_back( i );
+        if( (int)m_bList.at(i).size() >= m_parallelMin ) bigGroups++;
+    }
+    if( m_parallel && bigGroups > 1 ) // Send big groups to workers, except first one
+    {
+        QList<QFuture<bool>> futures;
+        bool first = true;
+        for( int i : m_toSolve )
+        {
+            if( (int)m_bList.at(i).size() < m_parallelMin ) continue;
+            if( first ) { first = false; continue; }
+            futures.append( QtConcurrent::run( &m_threadPool, this, &CircMatrix::solveGroup, i ) );
+            m_solveOk[i] = 2; // Running in worker
+        }
+        for( int i : m_toSolve ) if( m_solveOk[i] != 2 ) m_solveOk[i] = solveGroup( i );
 
-        m_eNodeActive = &(m_eNodeActList[i]);
-        int n = m_eNodeActive->size();
-
-        if( m_admitChanged[i] ) factorMatrix( n, i );
-        if( !luSolve( n, i ) ) ok = false;
+        int f = 0;
+        for( int i : m_toSolve ) if( m_solveOk[i] == 2 ) m_solveOk[i] = futures[f++].result();
+    }
+    else for( int i : m_toSolve ) m_solveOk[i] = solveGroup( i );
 
+    bool ok = true;
+    for( int i : m_toSolve ) // Set Node Voltages always in the same order
+    {
+        if( !m_solveOk[i] ) ok = false;
+        setVolts( i );
         m_currChanged[i]  = false;
         m_admitChanged[i] = false;
     }
     return ok;
 }
 
-void CircMatrix::factorMatrix( int n, int group ) // Factor matrix into Lower/Upper triangular
+bool CircMatrix::solveGroup( int group ) // Can run in a worker thread: don't touch eNodes here
 {
-    dp_matrix_t& ap = m_aList[group];
-    d_matrix_t&   a = m_aFaList[group];
-
-    /*std::cout << "\nAdmitance Matrix:\n"<< std::endl;
-    for( int i=0; i<n; i++ )
-    {
-        for( int j=0; j<n; ++j ) { std::cout << std::setw(15); std::cout << *ap[i][j]; }
-        std::cout << std::endl;
-    }*/
-
-    int row,col,k;
-
-    for( col=0; col<n; ++col )              // Crout's method: loop through columns
-    {
-        for( row=0; row<col; ++row )        // Upper triangular elements
-        {
-            double q = *(ap[row][col]);
-            for( k=0; k<row; ++k ) q -= a[row][k]*a[k][col];
-            a[row][col] = q;
-        }
-        for( row=col; row<n; ++row )        // Lower triangular elements
-        {
-            double q = *(ap[row][col]);
-            for( k=0; k<col; ++k ) q -= a[row][k]*a[k][col];
-            a[row][col] = q;
-        }
-        if( col != n-1 )                    // Normalize column respect to diagonal
-        {
-            double div = a[col][col];
-            if( div == 0 ) continue;
-            for( row=col+1; row<n; ++row ) a[row][col] /= div;
-        }
+    uint64_t time = 0;
+    if( m_profiling ) time = m_profTimer.nsecsElapsed();
+
+    int n = m_bList.at( group ).size();
+
+    d_vector_t& x = m_xList[group];
+    const dp_vector_t& bp = m_bList.at( group );
+    for( int i=0; i<n; ++i ) x[i] = *(bp[i]);
+
+    bool ok;
+    SparseLU* sparse = m_sparseList[group];
+    if( sparse ){
+        if( m_admitChanged[group] ) sparse->factor();
+        ok = sparse->solve( x, x );
+    }else{
+        DenseLU* dense = m_denseList[group];
+        if( m_admitChanged[group] ) dense->factor();
+        ok = dense->solve( x.data() );
     }
-    /*std::cout << "\nFactored Matrix:\n" << std::endl;
-    for( int i=0; i<n; i++ )
+    m_solveCount[group]++;  // Each group has it's own counters: safe in worker threads
+    if( m_profiling )
     {
-        for( int j=0; j<n; j++ ) { std::cout << std::setw(15); std::cout << a[i][j]; }
-        std::cout << std::endl;
-    }*/
+        m_groupTime[group] += m_profTimer.nsecsElapsed()-time;
+        m_groupSolves[group]++;
+    }
+    return ok;
+}
+
+void CircMatrix::clearProfile()
+{
+    m_groupSolves.assign( m_bList.size(), 0 );
+    m_groupTime.assign( m_bList.size(), 0 );
 }
 
-bool CircMatrix::luSolve( int n, int group ) // Solves the system to get voltages for each node
+void CircMatrix::setVolts( int group )
 {
-    const d_matrix_t&  a  = m_aFaList[group];
-    const dp_vector_t& bp = m_bList[group];
+    const QList<eNode*>& eNodeActive = m_eNodeActList.at( group );
+    const d_vector_t& x = m_xList[group];
 
-    /*std::cout << "\nCurrent vector:\n" << std::endl;
-    for( int i=0; i<n; i++ )
-    {
-        std::cout << std::setw(15); std::cout << *bp[i];
-        std::cout << std::endl;
-    }*/
+    for( int i=x.size()-1; i>=0; --i ) eNodeActive.at(i)->setVolt( x[i] ); // Set Node Voltages
+}
 
-    d_vector_t b;
-    b.resize( n , 0 );
+void CircMatrix::printStats()
+{
+    uint64_t full = 0, partial = 0, rank = 0, restore = 0;
+    factorStats( &full, &partial, &rank, &restore );
+    qDebug() << "    Matrix factorizations: Full"<< full <<"Partial"<< partial
+             <<"Rank-k"<< rank <<"Unchanged"<< restore;
+}
 
-    double tot;
-    int i;
-    for( i=0; i<n; ++i )
-    {
-        tot = *(bp[i]);
-        b[i] = tot;
-        if( tot != 0 ) break; // First nonzero b element
-    }
+uint64_t CircMatrix::factorizations() // Factorizations done, any kind
+{
+    uint64_t full = 0, partial = 0, rank = 0, restore = 0;
+    factorStats( &full, &partial, &rank, &restore );
+    return full+partial+rank;
+}
+
+uint64_t CircMatrix::groupFactors( int g )
+{
+    DenseLU* dense = m_denseList[g];
+    if( dense ) return dense->fullFactors()+dense->partialFactors()+dense->rankUpdates();
+    SparseLU* sparse = m_sparseList[g];
+    return sparse->fullFactors()+sparse->partialFactors();
+}
 
-    int bi = i++;
-    for( ; i<n; ++i )
+void CircMatrix::factorStats( uint64_t* full, uint64_t* partial, uint64_t* rank, uint64_t* restore )
+{
+    for( DenseLU* dense : m_denseList )
     {
-        tot = *(bp[i]);
-        for( int j=bi; j<i; ++j ) tot -= a[i][j]*b[j]; // Forward substitution from lower triangular matrix
-        b[i] = tot;
+        if( !dense ) continue;
+        *full    += dense->fullFactors();
+        *partial += dense->partialFactors();
+        *rank    += dense->rankUpdates();
+        *restore += dense->restores();
     }
-    bool isOk = true;
-
-    for( i=n-1; i>=0; --i )
+    for( SparseLU* sparse : m_sparseList )
     {
-        tot = b[i];
-        for( int j=i+1; j<n; ++j ) tot -= a[i][j]*b[j]; // Back substitution from upper triangular matrix
-
-        double div = a[i][i];
-        double volt = 0;
-        if( div != 0 ) volt = tot/div;
-        else isOk = false;
-
-        b[i] = volt;
-        m_eNodeActive->at(i)->setVolt( volt );         // Set Node Voltages
+        if( !sparse ) continue;
+        *full    += sparse->fullFactors();
+        *partial += sparse->partialFactors();
     }
-    return isOk;
 }
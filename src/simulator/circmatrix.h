@@ -8,64 +8,124 @@
 
 #include <vector>
 #include <QList>
+#include <QThreadPool>
+#include <QElapsedTimer>
 
 #include "e-node.h"
+#include "sparselu.h"
+#include "denselu.h"
 
 class CircMatrix
 {
     typedef std::vector<double>      d_vector_t;
     typedef std::vector<double*>     dp_vector_t;
-    typedef std::vector<d_vector_t>  d_matrix_t;
-    typedef std::vector<dp_vector_t> dp_matrix_t;
 
     public:
         CircMatrix();
         ~CircMatrix();
 
- static CircMatrix* self() { return m_pSelf; }
+ static CircMatrix* self() { return m_pSelf; } // CircMatrix of current Simulator in this thread
+
+        void makeCurrent() { m_pSelf = this; }
 
         void createMatrix( QList<eNode*> &eNodeList );
         bool solveMatrix();
 
         inline void stampDiagonal( int group, int n, double value ){
-            m_admitChanged[group] = true;
-            m_circMatrix[n-1][n-1] = value;      // eNode numbers start at 1
+            double* diagonal = m_diagonal[n-1];     // eNode numbers start at 1
+            if( *diagonal == value ) return;
+            *diagonal = value;
+            int i = m_nodeIndex[n-1];
+            entryChanged( group, i, i );
         }
         inline void stampMatrix( int row, int col, double value ){
-            m_circMatrix[row-1][col-1] = value;      // eNode numbers start at 1
+            int group = m_nodeGroup[row-1];             // eNode numbers start at 1
+            int i = m_nodeIndex[row-1];
+            int j = m_nodeIndex[col-1];
+            double* stampRow = m_stampRow[row-1];
+            double* entry;
+            if( stampRow ) entry = &stampRow[j];        // Dense group
+            else           entry = m_sparseList[group]->entry( i, j );
+            if( *entry == value ) return;
+            *entry = value;
+            entryChanged( group, i, j );
         }
         inline void stampCoef( int group, int row, double value ){
             m_currChanged[group] = true;
             m_coefVect[row-1] = value;
         }
 
+        void setSparseMin( int n ) { m_sparseMin = n; }
+        int  sparseMin() { return m_sparseMin; }
+
+        bool parallel() { return m_parallel; }
+        void setParallel( bool p ) { m_parallel = p; }
+
+        int  parallelMin() { return m_parallelMin; }
+        void setParallelMin( int n ) { m_parallelMin = n; }
+
+        void printStats();
+        uint64_t factorizations();
+
+        void setProfiling( bool p ) { m_profiling = p; }
+        void clearProfile();
+        int groups() { return m_bList.size(); }
+        int groupSize( int g ) { return m_bList.at( g ).size(); }
+        const QList<eNode*>& groupNodes( int g ) { return m_eNodeActList.at( g ); }
+        uint64_t groupSolves( int g ) { return m_groupSolves[g]; }
+        uint64_t groupTime( int g )   { return m_groupTime[g]; }  // ns
+        uint64_t groupSolveCount( int g ) { return m_solveCount[g]; } // Statistics since start
+        uint64_t groupFactors( int g );
+
     private:
- static CircMatrix* m_pSelf;
+ static thread_local CircMatrix* m_pSelf;
 
         void analyze();
-        void addConnections( int enodNum, QList<int>* nodeGroup, QList<int>* allNodes );
+        void clearGroups();
+        void factorStats( uint64_t* full, uint64_t* partial, uint64_t* rank, uint64_t* restore );
+
+        bool solveGroup( int group );
+        inline void setVolts( int group );
 
-        inline void factorMatrix( int n, int group );
-        inline bool luSolve( int n, int group );
+        inline void entryChanged( int group, int row, int col ){
+            m_admitChanged[group] = true;
+            DenseLU* dense = m_denseList[group];
+            if( dense ) dense->changed( row, col );
+            else        m_sparseList[group]->changed( row, col );
+        }
 
         int m_numEnodes;
+        int m_sparseMin;   // Groups with this number of nodes or more use sparse LU
+        int m_parallelMin; // Groups with this number of nodes or more can be solved in worker threads
+        bool m_parallel;
+        bool m_profiling;
         QList<eNode*>* m_eNodeList;
 
-        QList<dp_matrix_t> m_aList;
-        QList<d_matrix_t>  m_aFaList;
-        QList<dp_vector_t> m_bList;
+        std::vector<DenseLU*>   m_denseList;  // Dense groups, NULL for sparse
+        std::vector<SparseLU*>  m_sparseList; // Sparse groups, NULL for dense
+        QList<dp_vector_t>      m_bList;
 
         std::vector<bool>    m_admitChanged;
         std::vector<bool>    m_currChanged;
-        QList<eNode*>*       m_eNodeActive;
         QList<QList<eNode*>> m_eNodeActList;
 
-        d_matrix_t m_circMatrix;
+        std::vector<int>     m_nodeGroup;   // Group of each eNode
+        std::vector<int>     m_nodeIndex;   // Index of each eNode in it's group
+        std::vector<double*> m_diagonal;    // Diagonal element of each eNode
+        std::vector<double*> m_stampRow;    // Row of each eNode in dense groups
+
+        std::vector<d_vector_t> m_xList;    // Solution of each group
+        std::vector<char>       m_solveOk;
+        std::vector<int>        m_toSolve;  // Groups to solve in this step
+
         d_vector_t m_coefVect;
 
-        //bool m_admitChanged;
-        //bool m_currChanged;
-};
- #endif
+        std::vector<uint64_t> m_solveCount;  // Statistics
 
+        std::vector<uint64_t> m_groupSolves; // Profiling
+        std::vector<uint64_t> m_groupTime;
+        QElapsedTimer m_profTimer;
 
+        QThreadPool m_threadPool;
+};
+ #endif
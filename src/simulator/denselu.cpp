@@ -0,0 +1,353 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include "denselu.h"
+#include "simdkernels.h"
+
+DenseLU::DenseLU( int n )
+{
+    m_n = n;
+    m_stride = (n+3) & ~3; // Rows aligned to 4 doubles
+    m_maxRank = 8;
+
+    m_factored = false;
+    m_baseOk   = false;
+    m_lowRank  = true;
+    m_rank     = 0;
+
+    m_a.assign( n*m_stride, 0 );
+    m_base.assign( n*m_stride, 0 );
+    m_luBuf.assign( n*m_stride+4, 0 ); // +4: room for alignment
+    m_lu = align( m_luBuf );
+
+    m_cache.resize( 4 );               // Previous factorizations
+    m_cacheNext = 0;
+    for( factor_t& f : m_cache )
+    {
+        f.base.assign( n*m_stride, 0 );
+        f.luBuf.assign( n*m_stride+4, 0 );
+        f.lu = align( f.luBuf );
+        f.colCost.assign( n, 0 );
+        f.ok    = false;
+        f.valid = false;
+    }
+
+    m_rowChanged.assign( n, 0 );
+    m_changedRows.reserve( n );
+    m_updRows.reserve( n );
+    m_colCost.assign( n, 0 );
+    m_checkB.resize( n );
+    m_checkX.resize( n );
+
+    m_fullFactors    = 0;
+    m_partialFactors = 0;
+    m_rankUpdates    = 0;
+    m_restores       = 0;
+}
+DenseLU::~DenseLU(){}
+
+double* DenseLU::align( d_vector_t &buf ) // 32 bytes aligned start of buffer
+{
+    uintptr_t ptr = (uintptr_t)buf.data();
+    return (double*)((ptr+31) & ~(uintptr_t)31);
+}
+
+void DenseLU::factor()
+{
+    if( !m_factored || !m_lowRank ) { fullFactor(); newBase( true ); return; }
+
+    int n = m_n;
+    int m = n;   // First row/column different from last factorization
+    m_updRows.clear();
+    for( int r : m_changedRows )
+    {
+        const double* a = &m_a[r*m_stride];
+        const double* b = &m_base[r*m_stride];
+        int col = 0;
+        while( col<n && a[col] == b[col] ) col++;
+
+        if( col == n ) { m_rowChanged[r] = 0; continue; } // Back to previous value
+        m_updRows.push_back( r );
+        if( r   < m ) m = r;
+        if( col < m ) m = col;
+    }
+    m_changedRows.swap( m_updRows );
+    int k = m_changedRows.size();
+
+    if( k == 0 ) { m_rank = 0; m_restores++; return; } // Last factorization is still valid
+    if( restore() ) { m_restores++; return; }            // Same values as a previous factorization
+
+    double fullCost = n*n;  // Estimate costs from operations done in last factorization
+    double partCost = (n-m)*n;
+    for( int c=0; c<n; ++c )
+    {
+        fullCost += m_colCost[c];
+        if( c >= m ) partCost += m_colCost[c];
+        else         partCost += m_colCost[c]*(n-m)/(n-c); // Apply column c to trailing rows
+    }
+    double rankCost = (k+2)*n*n + k*k*n;     // k solves + check + I+D*Z
+
+    if( m_baseOk && k <= m_maxRank && rankCost < partCost && rankCost < fullCost )
+    {
+        if( rankUpdate( k ) ) { m_rankUpdates++; return; }
+    }
+    if( partCost < fullCost ) { store( true );  partialFactor( m ); newBase( false ); }
+    else                      { store( false ); fullFactor();       newBase( true );  }
+}
+
+bool DenseLU::restore() // Look for stamped values in previous factorizations
+{
+    int size = m_n*m_stride;
+    for( factor_t& f : m_cache )
+    {
+        if( !f.valid ) continue;
+        if( memcmp( m_a.data(), f.base.data(), size*sizeof(double) ) != 0 ) continue;
+
+        swapCurrent( f );
+        for( int r : m_changedRows ) m_rowChanged[r] = 0;
+        m_changedRows.clear();
+        m_rank = 0;
+        return true;
+    }
+    return false;
+}
+
+void DenseLU::store( bool keep ) // Save current factorization before replacing it
+{
+    if( m_cache.empty() ) return;
+    factor_t& f = m_cache[m_cacheNext];   // Replace oldest one
+    m_cacheNext = (m_cacheNext+1) % m_cache.size();
+
+    swapCurrent( f );
+    f.valid = true;
+    if( !keep ) return;                   // Will be fully overwritten
+
+    int size = m_n*m_stride;              // Partial factorization starts from current one
+    memcpy( m_base.data(), f.base.data(), size*sizeof(double) );
+    memcpy( m_lu, f.lu, size*sizeof(double) );
+    m_colCost = f.colCost;
+    m_baseOk  = f.ok;
+}
+
+void DenseLU::swapCurrent( factor_t& f )
+{
+    std::swap( m_base,    f.base );
+    std::swap( m_luBuf,   f.luBuf );
+    std::swap( m_lu,      f.lu );
+    std::swap( m_colCost, f.colCost );
+    std::swap( m_baseOk,  f.ok );
+}
+
+void DenseLU::fullFactor() // Factor matrix into Lower/Upper triangular
+{
+    int n = m_n;
+    int stride = m_stride;
+    double* a = m_lu;
+
+    memcpy( a, m_a.data(), n*stride*sizeof(double) ); // Gather stamped values
+
+    for( int k=0; k<n-1; ++k )               // Doolittle: eliminate column k from rows below
+    {
+        const double* rowK = a+k*stride;
+        double div = rowK[k];
+        int size = n-k-1;
+
+        double cost = 0;
+
+        for( int row=k+1; row<n; ++row )
+        {
+            double* rowR = a+row*stride;
+            double l = rowR[k];
+            if( l == 0 ) continue;
+            if( div != 0 ) l /= div;         // Normalize respect to diagonal
+            rowR[k] = l;
+            SimdKernels::subScaled( rowR+k+1, rowK+k+1, l, size );
+            cost += size;
+        }
+        m_colCost[k] = cost;
+    }
+    m_baseOk = true;
+    for( int i=0; i<n; ++i ) if( a[i*stride+i] == 0 ) m_baseOk = false;
+
+    m_factored = true;
+    m_fullFactors++;
+}
+
+void DenseLU::partialFactor( int m ) // Rows and columns before m didn't change: refactor trailing submatrix
+{
+    int n = m_n;
+    int stride = m_stride;
+    int size = n-m;
+    double* a = m_lu;
+
+    for( int row=m; row<n; ++row ) memcpy( a+row*stride+m, &m_a[row*stride+m], size*sizeof(double) );
+
+    for( int k=0; k<m; ++k )                 // Apply previous columns (L values didn't change)
+    {
+        const double* rowK = a+k*stride;
+        for( int row=m; row<n; ++row )
+        {
+            double* rowR = a+row*stride;
+            double l = rowR[k];
+            if( l == 0 ) continue;
+            SimdKernels::subScaled( rowR+m, rowK+m, l, size );
+    }   }
+    for( int k=m; k<n-1; ++k )               // Same as fullFactor() from here
+    {
+        const double* rowK = a+k*stride;
+        double div = rowK[k];
+        int size = n-k-1;
+
+        double cost = 0;
+
+        for( int row=k+1; row<n; ++row )
+        {
+            double* rowR = a+row*stride;
+            double l = rowR[k];
+            if( l == 0 ) continue;
+            if( div != 0 ) l /= div;
+            rowR[k] = l;
+            SimdKernels::subScaled( rowR+k+1, rowK+k+1, l, size );
+            cost += size;
+        }
+        m_colCost[k] = cost;
+    }
+    m_baseOk = true;
+    for( int i=0; i<n; ++i ) if( a[i*stride+i] == 0 ) m_baseOk = false;
+
+    m_partialFactors++;
+}
+
+bool DenseLU::rankUpdate( int k ) // A = Base + E*D  =>  A^-1 = B^-1 - Z*(I+D*Z)^-1*D*B^-1 , Z = B^-1*E
+{
+    int n = m_n;
+    m_d.resize( k*n );
+    m_z.resize( k*n );
+    m_s.resize( k*k );
+    m_t.resize( k );
+    m_sPiv.resize( k );
+
+    for( int p=0; p<k; ++p )
+    {
+        int r = m_changedRows[p];
+        double* d = &m_d[p*n];
+        double* z = &m_z[p*n];
+        const double* a = &m_a[r*m_stride];
+        const double* b = &m_base[r*m_stride];
+
+        for( int j=0; j<n; ++j ) { d[j] = a[j]-b[j]; z[j] = 0; }
+        z[r] = 1;
+        luSolve( z );
+    }
+    for( int p=0; p<k; ++p )
+        for( int q=0; q<k; ++q )
+            m_s[p*k+q] = (p==q ? 1 : 0) + SimdKernels::dotProd( &m_d[p*n], &m_z[q*n], n );
+
+    for( int c=0; c<k; ++c )                 // Factor I+D*Z with partial pivoting
+    {
+        int piv = c;
+        for( int r=c+1; r<k; ++r ) if( fabs( m_s[r*k+c] ) > fabs( m_s[piv*k+c] ) ) piv = r;
+        if( m_s[piv*k+c] == 0 ) { m_rank = 0; return false; }
+
+        m_sPiv[c] = piv;
+        if( piv != c ) for( int j=0; j<k; ++j ) std::swap( m_s[c*k+j], m_s[piv*k+j] );
+
+        double div = m_s[c*k+c];
+        for( int r=c+1; r<k; ++r )
+        {
+            double l = m_s[r*k+c]/div;
+            m_s[r*k+c] = l;
+            for( int j=c+1; j<k; ++j ) m_s[r*k+j] -= l*m_s[c*k+j];
+    }   }
+    m_rank = k;
+
+    double* b = m_checkB.data();            // Check accuracy: residual of A*x = b
+    double* x = m_checkX.data();
+    for( int i=0; i<n; ++i ) b[i] = x[i] = 1+(i*7)%11;
+    solve( x );
+    for( int i=0; i<n; ++i )
+    {
+        const double* a = &m_a[i*m_stride];
+        double res = -b[i];
+        double mag = fabs( b[i] );
+        for( int j=0; j<n; ++j ) { res += a[j]*x[j]; mag += fabs( a[j]*x[j] ); }
+        if( fabs( res ) <= mag*1e-11 ) continue;
+        m_rank = 0;                          // Bad conditioned, refactor
+        return false;
+    }
+    return true;
+}
+
+void DenseLU::newBase( bool all ) // Current values are now the base for next updates
+{
+    if( all ) m_base = m_a;
+    else for( int r : m_changedRows )
+        memcpy( &m_base[r*m_stride], &m_a[r*m_stride], m_n*sizeof(double) );
+
+    for( int r : m_changedRows ) m_rowChanged[r] = 0;
+    m_changedRows.clear();
+    m_rank = 0;
+}
+
+bool DenseLU::solve( double* x )
+{
+    bool isOk = luSolve( x );
+    if( !m_rank ) return isOk;
+
+    int n = m_n;
+    int k = m_rank;
+    double* t = m_t.data();
+
+    for( int p=0; p<k; ++p ) t[p] = SimdKernels::dotProd( &m_d[p*n], x, n ); // t = D*y
+
+    for( int c=0; c<k; ++c ) if( m_sPiv[c] != c ) std::swap( t[c], t[ m_sPiv[c] ] );
+
+    for( int c=0; c<k; ++c )                 // Solve (I+D*Z)*u = t
+        for( int r=c+1; r<k; ++r ) t[r] -= m_s[r*k+c]*t[c];
+
+    for( int r=k-1; r>=0; --r )
+    {
+        double tot = t[r];
+        for( int j=r+1; j<k; ++j ) tot -= m_s[r*k+j]*t[j];
+        t[r] = tot/m_s[r*k+r];
+    }
+    for( int q=0; q<k; ++q ) SimdKernels::subScaled( x, &m_z[q*n], t[q], n ); // x = y - Z*u
+
+    return isOk;
+}
+
+bool DenseLU::luSolve( double* b ) // Solves the system in place
+{
+    int n = m_n;
+    int stride = m_stride;
+    const double* a = m_lu;
+
+    int i;
+    for( i=0; i<n; ++i ) if( b[i] != 0 ) break; // First nonzero b element
+
+    int bi = i++;
+    for( ; i<n; ++i ) // Forward substitution from lower triangular matrix
+        b[i] -= SimdKernels::dotProd( a+i*stride+bi, b+bi, i-bi );
+
+    bool isOk = true;
+
+    for( i=n-1; i>=0; --i ) // Back substitution from upper triangular matrix
+    {
+        const double* row = a+i*stride;
+        double tot = b[i] - SimdKernels::dotProd( row+i+1, b+i+1, n-i-1 );
+
+        double div = row[i];
+        double volt = 0;
+        if( div != 0 ) volt = tot/div;
+        else isOk = false;
+
+        b[i] = volt;
+    }
+    return isOk;
+}
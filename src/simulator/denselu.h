@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef DENSELU_H
+#define DENSELU_H
+
+#include <vector>
+#include <cstdint>
+
+// Dense LU factorization for small node groups.
+// Stamped values in one row-major buffer, rows padded to 4 doubles.
+// Tracks changed entries since last factorization. factor() then, by estimated cost:
+// - reuses a previous factorization if values are the same (switches toggling back),
+// - refactors only the trailing submatrix after the first changed row/column,
+// - applies a rank-k update (Sherman-Morrison-Woodbury) over the last factorization,
+// - or does a full refactorization.
+
+class DenseLU
+{
+    typedef std::vector<double> d_vector_t;
+
+    struct factor_t    // Saved factorization
+    {
+        d_vector_t base;
+        d_vector_t luBuf;
+        double*    lu;
+        d_vector_t colCost;
+        bool ok;
+        bool valid;
+    };
+
+    public:
+        DenseLU( int n );
+        ~DenseLU();
+
+        inline double* row( int i ) { return &m_a[i*m_stride]; }
+
+        inline void changed( int row, int col ) // Stamped value at row,col changed
+        {
+            if( m_rowChanged[row] ) return;
+            m_rowChanged[row] = 1;
+            m_changedRows.push_back( row );
+        }
+
+        void factor();
+        bool solve( double* x ); // x: current vector in, voltages out
+
+        int size() { return m_n; }
+
+        void setLowRank( bool l ) { m_lowRank = l; }
+
+        uint64_t fullFactors()    { return m_fullFactors; }
+        uint64_t partialFactors() { return m_partialFactors; }
+        uint64_t rankUpdates()    { return m_rankUpdates; }
+        uint64_t restores()       { return m_restores; }
+
+    private:
+        void fullFactor();
+        void partialFactor( int m );
+        bool rankUpdate( int k );
+        void newBase( bool all );
+        bool restore();
+        void store( bool keep );
+        void swapCurrent( factor_t &f );
+        double* align( d_vector_t &buf );
+        bool luSolve( double* x );
+
+        int m_n;
+        int m_stride;
+        int m_maxRank;
+
+        bool m_factored;
+        bool m_baseOk;   // Last factorization without zero pivots
+        bool m_lowRank;  // Allow partial/rank-k updates
+
+        d_vector_t m_a;     // Stamped values
+        d_vector_t m_base;  // Values at last factorization
+        d_vector_t m_luBuf;
+        double*    m_lu;    // Factored matrix, 32 bytes aligned
+
+        d_vector_t m_colCost; // Operations eliminating each column in last factorization
+
+        std::vector<char> m_rowChanged; // Rows changed since last factorization
+        std::vector<int>  m_changedRows;
+
+        std::vector<factor_t> m_cache; // Previous factorizations: switches toggle between a few states
+        int m_cacheNext;
+
+        int m_rank;                     // Rank-k update in use (0 = none)
+        std::vector<int> m_updRows;
+        d_vector_t m_d;   // k x n: changed rows minus base rows
+        d_vector_t m_z;   // k x n: base^-1 * unit vector of each changed row
+        d_vector_t m_s;   // k x k: I + D*Z factored
+        d_vector_t m_t;   // k
+        std::vector<int> m_sPiv;
+        d_vector_t m_checkB;
+        d_vector_t m_checkX;
+
+        uint64_t m_fullFactors;
+        uint64_t m_partialFactors;
+        uint64_t m_rankUpdates;
+        uint64_t m_restores;
+};
+
+#endif
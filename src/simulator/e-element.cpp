@@ -11,20 +11,24 @@ eElement::eElement( QString id )
 {
     m_elmId = id;
     nextChanged = NULL;
-    nextEvent  = NULL;
-    eventTime = 0;
+    nlBatch = NULL;
+    eventTime  = 0;
+    eventOrder = 0;
+    eventIndex = -1;
+    profile = profile_t();
     m_pendingTime = 0;
     added = false;
     m_step = 0;
 
-    if( Simulator::self() ) Simulator::self()->addToElementList( this );
+    m_sim = Simulator::self();
+    if( m_sim ) m_sim->addToElementList( this );
 }
 eElement::~eElement()
 {
     m_ePin.clear();
-    if( !Simulator::self() ) return;
-    Simulator::self()->remFromElementList( this );
-    Simulator::self()->cancelEvents( this );
+    if( !m_sim ) return; // Simulator already deleted
+    m_sim->remFromElementList( this );
+    m_sim->cancelEvents( this );
 }
 
 void eElement::setNumEpins( int n )
@@ -46,8 +50,8 @@ void eElement::pauseEvents()
 {
     if( eventTime )
     {
-        m_pendingTime = eventTime - Simulator::self()->circTime();
-        Simulator::self()->cancelEvents( this );
+        m_pendingTime = eventTime - m_sim->circTime();
+        m_sim->cancelEvents( this );
     }
     else m_pendingTime = 0;
 }
@@ -55,6 +59,6 @@ void eElement::pauseEvents()
 void eElement::resumeEvents()
 {
     if( !m_pendingTime ) return;
-    Simulator::self()->addEvent( m_pendingTime, this );
+    m_sim->addEvent( m_pendingTime, this );
     m_pendingTime = 0;
 }
@@ -10,10 +10,25 @@
 #include <QString>
 
 class ePin;
+class Simulator;
+class NlBatch;
+class QDataStream;
+class QByteArray;
+class AcAnalysis;
 
 class eElement
 {
     public:
+        struct profile_t   // Filled by Simulator when profiling
+        {
+            uint64_t events;
+            uint64_t eventTime;   // ns
+            uint64_t voltChanges;
+            uint64_t voltTime;
+            uint64_t nlIters;
+            uint64_t nlTime;
+        };
+
         eElement( QString id );
         virtual ~eElement();
 
@@ -23,6 +38,15 @@ class eElement
         virtual void runEvent(){;}
         virtual void voltChanged(){;}
 
+        virtual void setOpPoint( bool op ){;} // DC operating point: Capacitors open, Inductors short
+
+        virtual bool saveState( QDataStream& out ){ return false; } // Internal state for Simulator checkpoints, false if not supported
+        virtual void loadState( QDataStream& in ){;}  // Elements not overriding these restart from stamp() state
+
+        virtual void replayInput( const QByteArray& data ){;} // Recorded external input, see Stimulus
+
+        virtual void stampAc( AcAnalysis* ac, double omega ){;} // AC analysis: frequency dependent admitances
+
         virtual void setNumEpins( int n );
 
         virtual ePin* getEpin( int num );
@@ -38,12 +62,20 @@ class eElement
 
         // Simulator engine
         eElement* nextChanged;
+        NlBatch*  nlBatch;   // Evaluates voltChanged() with other elements of same type, NULL if none
         bool added;
 
-        eElement* nextEvent;
         uint64_t eventTime;
+        uint64_t eventOrder;
+        int eventIndex;      // Slot in Simulator event queue, -1 if not scheduled
+
+        profile_t profile;
+
+        void detachSim() { m_sim = NULL; } // Simulator deleted before this element
 
     protected:
+        Simulator* m_sim;    // Simulator current when this was created
+
         uint64_t m_pendingTime;
 
         std::vector<ePin*> m_ePin;
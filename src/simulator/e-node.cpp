@@ -3,6 +3,8 @@
  *                                                                         *
  ***( see copyright.txt file at root folder )*******************************/
 
+#include <QDataStream>
+
 #include "e-node.h"
 #include "pin.h"
 #include "e-pin.h"
@@ -11,10 +13,17 @@
 #include "circmatrix.h"
 #include "simulator.h"
 
+
 eNode::eNode( QString id )
 {
     m_id = id;
     m_nodeNum = 0;
+    m_nodeGroup = -1;
+    m_gmin = 0;
+    m_frontVolt = 0;
+    m_frontChanged = false;
+    m_voltChanged  = false;
+    m_single  = false;
 
     m_voltChEl     = NULL;
     m_nonLinEl     = NULL;
@@ -23,21 +32,30 @@ eNode::eNode( QString id )
     m_firstCurrent = NULL;
     m_nodeAdmit    = NULL;
 
-    if( !id.isEmpty() ) Simulator::self()->addToEnodeList( this );
+    m_sim = Simulator::self();
+    if( m_sim )
+    {
+        m_arenas = m_sim->nodeArenas();
+        m_arenas->ref();
+    }
+    else m_arenas = new Arenas(); // No Simulator (static eNodes): own items
+    if( !id.isEmpty() ) m_sim->addToEnodeList( this );
 }
 eNode::~eNode()
 {
-    clearElmList( m_voltChEl );
-    clearElmList( m_nonLinEl );
-    clearConnList( m_firstAdmit );
-    clearConnList( m_firstSingAdm );
-    clearConnList( m_firstCurrent );
-    clearConnList( m_nodeAdmit );
+    m_arenas->elm.putList( m_voltChEl );
+    m_arenas->elm.putList( m_nonLinEl );
+    m_arenas->conn.putList( m_firstAdmit );
+    m_arenas->conn.putList( m_firstSingAdm );
+    m_arenas->conn.putList( m_firstCurrent );
+    m_arenas->conn.putList( m_nodeAdmit );
+    m_arenas->unref();
 }
 
 void eNode::initialize()
 {
-    m_voltChanged  = true; // Used for wire animation
+    m_voltChanged  = false;
+    voltChanged();         // Used for wire animation
     //m_switched     = false;
     m_single       = false;
     m_changed      = false;
@@ -46,60 +64,75 @@ void eNode::initialize()
     m_nodeGroup = -1;
     nextCH = NULL;
     m_volt = 0;
+    m_gmin = 0;
+    m_totalAdmit = 0;
+    m_frontVolt = 0;
+    m_frontChanged = true;
 
-    clearElmList( m_voltChEl );
+    for( ePin* epin : m_ePinList ) epin->clearSlots(); // Connections will be created again
+
+    m_arenas->elm.putList( m_voltChEl );
     m_voltChEl = NULL;
 
-    clearElmList( m_nonLinEl );
+    m_arenas->elm.putList( m_nonLinEl );
     m_nonLinEl = NULL;
 
-    clearConnList( m_firstAdmit );
+    m_arenas->conn.putList( m_firstAdmit );
     m_firstAdmit = NULL;
 
-    clearConnList( m_firstSingAdm );
+    m_arenas->conn.putList( m_firstSingAdm );
     m_firstSingAdm = NULL;
 
-    clearConnList( m_firstCurrent );
+    m_arenas->conn.putList( m_firstCurrent );
     m_firstCurrent = NULL;
 
-    clearConnList( m_nodeAdmit );
+    m_arenas->conn.putList( m_nodeAdmit );
     m_nodeAdmit = NULL;
 
     m_nodeList.clear();
 }
 
+eNode::Connection* eNode::newConnection( ePin* epin, int node, double value )
+{
+    Connection* conn = m_arenas->conn.get();
+    conn->epin  = epin;
+    conn->node  = node;
+    conn->value = value;
+    conn->nodeAdm = NULL;
+    return conn;
+}
+
+eNode::Connection* eNode::nodeAdmit( ePin* epin, int node ) // Admitance to node (reusing Connection class)
+{
+    Connection* na = m_nodeAdmit;
+    while( na ){
+        if( na->node == node ) return na; // Node already in the list
+        na = na->next;
+    }
+    na = newConnection( epin, node );
+    na->next = m_nodeAdmit;  // Prepend
+    m_nodeAdmit = na;
+
+    m_nodeList.append( node ); // Used by CircMatrix
+    return na;
+}
+
 void eNode::addConnection( ePin* epin, int node )
 {
     if( node == m_nodeNum ) return;// Be sure msg doesn't come from this node
+    if( epin->m_admitSlot ) return; // Connection already in the list
 
-    Connection* first = m_firstAdmit; // Create list of connections
-    while( first ){
-        if( first->epin == epin ) return; // Connection already in the list
-        first = first->next;
-    }
-    Connection* conn = new Connection( epin, node );
+    Connection* conn = newConnection( epin, node );
+    conn->nodeAdm = nodeAdmit( epin, node );
     conn->next = m_firstAdmit;  // Prepend
     m_firstAdmit = conn;
 
-    first = m_nodeAdmit;            // Create list of admitances to nodes (reusing Connection class)
-    while( first ){
-        if( first->node == node ) return; // Node already in the list
-        first = first->next;
-    }
-    conn = new Connection( epin, node );
-    conn->next = m_nodeAdmit;  // Prepend
-    m_nodeAdmit = conn;
-
-    if( !m_nodeList.contains( node ) ) m_nodeList.append( node ); // Used by CircMatrix
+    epin->m_admitSlot = conn;
 }
 
-void eNode::stampAdmitance( ePin* epin, double admit ) // Be sure msg doesn't come from this node
+void eNode::stampAdmitance( Connection* conn, double admit )
 {
-    Connection* conn = m_firstAdmit;
-    while( conn ){
-        if( conn->epin == epin ) { conn->value = admit; break; } // Connection found
-        conn = conn->next;
-    }
+    if( conn ) conn->value = admit;
 
     //if( admit == 0 ) m_switched = true;
     m_admitChanged = true;
@@ -108,34 +141,20 @@ void eNode::stampAdmitance( ePin* epin, double admit ) // Be sure msg doesn't co
 
 void eNode::addSingAdm( ePin* epin, int node, double admit )
 {
-    Connection* conn = new Connection( epin, node );
+    Connection* conn = newConnection( epin, node, admit );
+    conn->nodeAdm = nodeAdmit( epin, node );
     conn->next = m_firstSingAdm;  // Prepend
     m_firstSingAdm = conn;
-    conn->value = admit;
 
-    conn = NULL;
-    Connection* first = m_nodeAdmit;   // Create list of admitances to nodes (reusing Connection class)
-    while( first ){
-        if( first->node == node )  { conn = first; break; }// Node already in the list
-        first = first->next;
-    }
-    if( !conn ){
-        conn = new Connection( epin, node );
-        conn->next = m_nodeAdmit;  // Prepend
-        m_nodeAdmit = conn;
-    }
-    if( !m_nodeList.contains( node ) ) m_nodeList.append( node ); // Used by CircMatrix
+    epin->m_singSlot = conn;
     m_admitChanged = true;
     changed();
 }
 
-void eNode::stampSingAdm( ePin* epin, double admit )
+void eNode::stampSingAdm( Connection* conn, double admit )
 {
-    Connection* conn = m_firstSingAdm;
-    while( conn ){
-        if( conn->epin == epin ) { conn->value = admit; break; } // Connection found
-        conn = conn->next;
-    }
+    if( conn ) conn->value = admit;
+
     /// if( admit == 0 ) m_switched = true;
     m_admitChanged = true;
     changed();
@@ -143,33 +162,56 @@ void eNode::stampSingAdm( ePin* epin, double admit )
 
 void eNode::createCurrent( ePin* epin )
 {
-    Connection* first = m_firstCurrent;
+    if( epin->m_currSlot ) return; // Element already in the list
 
-    while( first ){
-        if( first->epin == epin ) return; // Element already in the list
-        first = first->next;
-    }
-    Connection* conn = new Connection( epin );
+    Connection* conn = newConnection( epin );
     conn->next = m_firstCurrent;  // Prepend
     m_firstCurrent = conn;
+
+    epin->m_currSlot = conn;
 }
 
-void eNode::stampCurrent( ePin* epin, double current ) // Be sure msg doesn't come from this node
+void eNode::stampCurrent( Connection* conn, double current )
 {
-    Connection* conn = m_firstCurrent;
-    while( conn ){
-        if( conn->epin == epin ) { conn->value = current; break; } // Connection found
-        conn = conn->next;
-    }
+    if( conn ) conn->value = current;
+
     m_currChanged = true;
     changed();
 }
 
+void eNode::nodeAdmitances( std::vector<int>& nodes, std::vector<double>& admits ) // As stamped in matrix
+{
+    nodes.clear();
+    admits.clear();
+    Connection* na = m_nodeAdmit;
+    while( na ){
+        if( na->node > 0 ){
+            nodes.push_back( na->node );
+            admits.push_back( na->value );
+        }
+        na = na->next;
+}   }
+
+void eNode::setGmin( double gmin )
+{
+    if( m_gmin == gmin ) return;
+    m_gmin = gmin;
+    m_admitChanged = true;
+    changed();
+}
+
 void eNode::changed()
 {
     if( m_changed ) return;
     m_changed = true;
-    Simulator::self()->addToChangedNodes( this );
+    m_sim->addToChangedNodes( this );
+}
+
+void eNode::voltChanged()
+{
+    if( m_voltChanged ) return;
+    m_voltChanged = true;
+    m_sim->addToAnimNodes( this );
 }
 
 void eNode::stampMatrix()
@@ -179,7 +221,7 @@ void eNode::stampMatrix()
 
     if( m_admitChanged )
     {
-        m_totalAdmit = 0;
+        m_totalAdmit = m_gmin;
         //if( m_switched ) m_totalAdmit += 1e-12; // Weak connection to ground
 
         if( m_single ){
@@ -192,39 +234,23 @@ void eNode::stampMatrix()
             Connection* conn = m_firstAdmit; // Full Admitances
             while( conn ){
                 double adm = conn->value;
-                int  enode = conn->node;
-
-                if( enode > 0 ){        // Calculate admitances to nodes
-                    na = m_nodeAdmit;
-                    while( na ){
-                        if( na->node == enode ){ na->value += adm; break; }
-                        na = na->next;
-                    }
-                }
+                if( conn->node > 0 ) conn->nodeAdm->value += adm; // Calculate admitances to nodes
+
                 m_totalAdmit += adm;    // Calculate total admitance
                 conn = conn->next;
             }
-            CircMatrix::self()->stampDiagonal( m_nodeGroup, m_nodeNum, m_totalAdmit ); // Stamp diagonal
+            m_sim->matrix()->stampDiagonal( m_nodeGroup, m_nodeNum, m_totalAdmit ); // Stamp diagonal
 
             conn = m_firstSingAdm;      // Single admitance values
             while( conn ){
-                double adm = conn->value;
-                int  enode = conn->node;
-
-                if( enode > 0 ){        // Add sinle admitance to node
-                    na = m_nodeAdmit;
-                    while( na ){
-                        if( na->node == enode ){ na->value += adm; break; }
-                        na = na->next;
-                    }
-                }
+                if( conn->node > 0 ) conn->nodeAdm->value += conn->value; // Add sinle admitance to node
                 conn = conn->next;
             }
             na = m_nodeAdmit;
             while( na ){                  // Stamp non diagonal
                 int    enode = na->node;
                 double admit = na->value;
-                if( enode > 0 ) CircMatrix::self()->stampMatrix( m_nodeNum, enode, -admit );
+                if( enode > 0 ) m_sim->matrix()->stampMatrix( m_nodeNum, enode, -admit );
                 na = na->next;
             }
         }
@@ -236,7 +262,7 @@ void eNode::stampMatrix()
         Connection* conn = m_firstCurrent;
         while( conn ){ m_totalCurr += conn->value; conn = conn->next; } // Calculate total current
 
-        if( !m_single ) CircMatrix::self()->stampCoef(  m_nodeGroup, m_nodeNum, m_totalCurr );
+        if( !m_single ) m_sim->matrix()->stampCoef(  m_nodeGroup, m_nodeNum, m_totalCurr );
         m_currChanged  = false;
     }
     if( m_single ) solveSingle();
@@ -255,8 +281,9 @@ void  eNode::setVolt( double v )
 {
     if( m_volt == v ) return;
 
-    m_voltChanged = true; // Used for wire animation
+    voltChanged(); // Used for wire animation
     m_volt = v;
+    m_sim->m_voltSetCount++;
 
     CallBackElement* linked = m_voltChEl; // VoltChaneg callback
     while( linked )
@@ -264,7 +291,7 @@ void  eNode::setVolt( double v )
         eElement* el = linked->element;
         linked = linked->next;
         if( el->added ) continue;
-        Simulator::self()->addToChangedList( el );
+        m_sim->addToChangedList( el );
         el->added = true;
     }
     linked = m_nonLinEl ;              // Non Linear callback
@@ -273,22 +300,25 @@ void  eNode::setVolt( double v )
         eElement* el = linked->element;
         linked = linked->next;
         if( el->added ) continue;
-        Simulator::self()->addToNoLinList( el );
+        m_sim->addToNoLinList( el, m_nodeGroup+1 );
         el->added = true;
     }
 }
 
-void eNode::addEpin( ePin* epin )
-{ if( !m_ePinList.contains(epin)) m_ePinList.append(epin); }
+void eNode::addEpin( ePin* epin ) // ePin::setEnode() makes sure it's not already here
+{ m_ePinList.append( epin ); }
 
 void eNode::remEpin( ePin* epin )
 {
-    if( m_ePinList.contains(epin) ) m_ePinList.removeOne( epin );
+    m_ePinList.removeOne( epin );
 }
 
 void eNode::clear()
 {
-    for( ePin* epin : m_ePinList ){
+    QList<ePin*> ePinList = m_ePinList;
+    m_ePinList.clear();         // Don't remove ePins one by one
+
+    for( ePin* epin : ePinList ){
         epin->setEnode( NULL );
         epin->setEnodeComp( NULL );
 }   }
@@ -304,7 +334,8 @@ void eNode::voltChangedCallback( eElement* el )
         if( el == changed->element ) return; // Element already in the list
         changed = changed->next;
     }
-    CallBackElement* newLinked = new CallBackElement( el );
+    CallBackElement* newLinked = m_arenas->elm.get();
+    newLinked->element = el;
     newLinked->next = m_voltChEl; // Prepend
     m_voltChEl = newLinked;
 }
@@ -321,7 +352,7 @@ void eNode::remFromChangedCallback( eElement* el )
         {
             if( last ) last->next = next;
             else       m_voltChEl = next;
-            delete changed;//changed->next = NULL;
+            m_arenas->elm.put( changed );
         }
         else last = changed;
         changed = next;
@@ -336,40 +367,93 @@ void eNode::addToNoLinList( eElement* el )
         if( el == changed->element ) return; // Element already in the list
         changed = changed->next;
     }
-    CallBackElement* newLinked = new CallBackElement( el );
+    CallBackElement* newLinked = m_arenas->elm.get();
+    newLinked->element = el;
     newLinked->next = m_nonLinEl; // Prepend
     m_nonLinEl = newLinked;
     //qDebug() <<m_id<< el->getId();
 }
 
-void eNode::updateConnectors()
+void eNode::saveState( QDataStream& out )
 {
-    if( !m_voltChanged ) return;
-    m_voltChanged = false;
+    out << m_volt << m_gmin;
 
-    for( ePin* epin : m_ePinList ){
-        Pin* pin = epin->getPin();
-        if( pin && pin->isVisible() ){
-            Connector* conn = pin->connector();
-            if( conn ) conn->updateLines();
-        }
+    Connection* lists[3] = { m_firstAdmit, m_firstSingAdm, m_firstCurrent };
+    for( Connection* conn : lists )
+    {
+        quint32 size = 0;
+        for( Connection* c = conn; c; c = c->next ) size++;
+        out << size;
+        for( Connection* c = conn; c; c = c->next ) out << c->value;
     }
 }
 
-void eNode::clearElmList( CallBackElement* first )
+bool eNode::checkState( QDataStream& in ) // Read saved state without changing anything
 {
-    while( first ){
-        CallBackElement* del = first;
-        first = first->next;
-        delete del;
+    double value;
+    in >> value >> value; // Volt, gmin
+
+    Connection* lists[3] = { m_firstAdmit, m_firstSingAdm, m_firstCurrent };
+    for( Connection* conn : lists )
+    {
+        quint32 size = 0;
+        for( Connection* c = conn; c; c = c->next ) size++;
+        quint32 saved;
+        in >> saved;
+        if( saved != size ) return false;
+        for( quint32 i=0; i<saved; ++i ) in >> value;
     }
+    return in.status() == QDataStream::Ok;
 }
 
-void eNode::clearConnList( Connection* first )
+bool eNode::loadState( QDataStream& in ) // Same circuit: same Connections in same order
 {
-    while( first ){
-        Connection* del = first;
-        first = first->next;
-        delete del;
+    in >> m_volt >> m_gmin;
+    m_frontVolt = m_volt;
+
+    Connection* lists[3] = { m_firstAdmit, m_firstSingAdm, m_firstCurrent };
+    for( Connection* conn : lists )
+    {
+        quint32 size = 0;
+        for( Connection* c = conn; c; c = c->next ) size++;
+        quint32 saved;
+        in >> saved;
+        if( saved != size ) return false;
+        for( Connection* c = conn; c; c = c->next ) in >> c->value;
+    }
+    voltChanged();
+    m_admitChanged = true; // Stamp all again
+    m_currChanged  = true;
+    m_changed = false;
+    changed();
+    return in.status() == QDataStream::Ok;
+}
+
+void eNode::getCallBacks( QSet<eElement*>& elements )
+{
+    for( CallBackElement* cb = m_voltChEl; cb; cb = cb->next ) elements.insert( cb->element );
+    for( CallBackElement* cb = m_nonLinEl; cb; cb = cb->next ) elements.insert( cb->element );
+}
+
+void eNode::takeSnapshot()
+{
+    if( !m_voltChanged ) return;
+    m_voltChanged = false;
+
+    m_frontVolt = m_volt;
+    m_frontChanged = true;
+}
+
+void eNode::getConnectors( QSet<Connector*>& connectors )
+{
+    if( !m_frontChanged ) return;
+    m_frontChanged = false;
+
+    for( ePin* epin : m_ePinList ){
+        Pin* pin = epin->getPin();
+        if( pin && pin->isVisible() ){
+            Connector* conn = pin->connector();
+            if( conn ) connectors.insert( conn );
+        }
     }
 }
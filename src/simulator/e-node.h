@@ -7,13 +7,61 @@
 #define ENODE_H
 
 #include<QHash>
+#include <QSet>
+#include <vector>
+#include <atomic>
+
+#include "arena.h"
 
 class ePin;
 class eElement;
+class QDataStream;
+class Simulator;
+class Connector;
 
 class eNode
 {
     public:
+        class Connection
+        {
+            public:
+                Connection( ePin* e=NULL, int n=0, double v=0 ){ epin = e; node = n; value = v; nodeAdm = NULL; }
+                ~Connection(){;}
+
+                Connection* next;
+                Connection* nodeAdm; // Admitance to this node (in m_nodeAdmit)
+                ePin*  epin;
+                int    node;
+                double value;
+        };
+
+        class CallBackElement
+        {
+            public:
+                CallBackElement( eElement* el=NULL ) { element = el; }
+                ~CallBackElement(){;}
+
+                CallBackElement* next;
+                eElement* element;
+        };
+
+        class Arenas  // Link items of all eNodes in a Simulator
+        {
+            public:
+                Arenas() { m_refs = 1; }
+
+                void ref() { m_refs++; }
+                void unref() { if( --m_refs == 0 ) delete this; } // Simulator and eNodes gone
+
+                Arena<Connection>      conn;
+                Arena<CallBackElement> elm;
+
+            private:
+                ~Arenas(){;}
+
+                std::atomic<int> m_refs;
+        };
+
         eNode( QString id );
         ~eNode();
 
@@ -29,19 +77,23 @@ class eNode
         void addToNoLinList( eElement* el );
         //void remFromNoLinList( eElement* el );
 
-        void addConnection( ePin* epin, int node );
-        void stampAdmitance( ePin* epin, double admit );
+        void addConnection( ePin* epin, int node );        // Connections are slots stored in ePin
+        void stampAdmitance( Connection* conn, double admit );
 
         void addSingAdm( ePin* epin, int node, double admit );
-        void stampSingAdm( ePin* epin, double admit );
+        void stampSingAdm( Connection* conn, double admit );
 
         void createCurrent( ePin* epin );
-        void stampCurrent( ePin* epin, double current );
+        void stampCurrent( Connection* conn, double current );
 
         int  getNodeNumber() { return m_nodeNum; }
         void setNodeNumber( int n ) { m_nodeNum = n; }
 
         void setNodeGroup( int n ){ m_nodeGroup = n; }
+        int  nodeGroup() { return m_nodeGroup; } // CircMatrix group, -1 for single eNodes
+
+        double totalAdmit() { return m_totalAdmit; } // Last stamped values, used in AC analysis
+        void nodeAdmitances( std::vector<int>& nodes, std::vector<double>& admits );
 
         double getVolt() { return m_volt; }
         void   setVolt( double volt );
@@ -52,44 +104,38 @@ class eNode
         void stampMatrix();
 
         void setSingle( bool single ) { m_single = single; } // This eNode can calculate it's own Volt
+
+        void setGmin( double gmin );  // Conductance to ground, used in DC operating point
         //void setSwitched( bool switched ){ m_switched = switched; } // This eNode has switches attached
 
-        void updateConnectors();
+        void saveState( QDataStream& out ); // Volt and stamped values for Simulator checkpoints
+        bool loadState( QDataStream& in );
+        bool checkState( QDataStream& in ); // Saved state matches this eNode
+        void getCallBacks( QSet<eElement*>& elements ); // Elements called when this eNode changes
+
+        void takeSnapshot();     // Copy Volt to front buffer, called with simulation stopped
+        void getConnectors( QSet<Connector*>& connectors ); // Visible wires of this eNode
+
+        double frontVolt() { return m_frontVolt; }
 
         QList<ePin*> getEpins() { return m_ePinList; }
 
         QList<int> getConnections();
 
         eNode* nextCH;
+        eNode* nextAnim; // Simulator list of eNodes to animate
 
     private:
-        class Connection
-        {
-            public:
-                Connection( ePin* e, int n=0, double v=0 ){ epin = e; node = n; value = v; }
-                ~Connection(){;}
-
-                Connection* next;
-                ePin*  epin;
-                int    node;
-                double value;
-        };
-        class CallBackElement
-        {
-            public:
-                CallBackElement( eElement* el ) { element = el; }
-                ~CallBackElement(){;}
-
-                CallBackElement* next;
-                eElement* element;
-        };
-
         inline void changed();
+        inline void voltChanged();
 
         inline void solveSingle();
 
-        void clearElmList( CallBackElement* first );
-        void clearConnList( Connection* first );
+        Connection* newConnection( ePin* epin, int node=0, double value=0 );
+        Connection* nodeAdmit( ePin* epin, int node );
+
+        Simulator* m_sim;  // Simulator current when this was created
+        Arenas* m_arenas;  // Shared with all eNodes of m_sim, reused in every run
 
         QString m_id;
 
@@ -107,7 +153,9 @@ class eNode
 
         double m_totalCurr;
         double m_totalAdmit;
+        double m_gmin;
         double m_volt;
+        double m_frontVolt; // Volt at last frame, read by GUI
 
         int m_nodeNum;
         int m_nodeGroup;
@@ -115,6 +163,7 @@ class eNode
         bool m_currChanged;
         bool m_admitChanged;
         bool m_voltChanged;
+        bool m_frontChanged;
         bool m_changed;
         bool m_single;
         //bool m_switched;
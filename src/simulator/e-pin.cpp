@@ -13,6 +13,7 @@ ePin::ePin( QString id, int index )
     m_enode    = NULL;
     m_enodeComp = NULL;
     m_inverted = false;
+    clearSlots();
 }
 ePin::~ePin()
 {
@@ -22,6 +23,7 @@ ePin::~ePin()
 void ePin::setEnode( eNode* enode )
 {
     if( enode == m_enode ) return;
+    clearSlots();              // Connections belong to old eNode
 
     if( m_enode ) m_enode->remEpin( this );
     if( enode ) enode->addEpin( this );
@@ -43,7 +45,7 @@ void ePin::addSingAdm( int node, double admit )
 
 void ePin::stampSingAdm( double admit )
 {
-    if( m_enode ) m_enode->stampSingAdm( this, admit );
+    if( m_enode ) m_enode->stampSingAdm( m_singSlot, admit );
 }
 
 void ePin::createCurrent()
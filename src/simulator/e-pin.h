@@ -15,6 +15,7 @@ class Pin;
 
 class ePin
 {
+        friend class eNode;
     public:
         ePin( QString id, int index );
         virtual ~ePin();
@@ -32,13 +33,13 @@ class ePin
         bool inverted() { return m_inverted; }
         virtual void setInverted( bool inverted ) { m_inverted = inverted; }
 
-        inline void stampAdmitance( double data ) { if( m_enode ) m_enode->stampAdmitance( this, data ); }
+        inline void stampAdmitance( double data ) { if( m_enode ) m_enode->stampAdmitance( m_admitSlot, data ); }
 
         void addSingAdm( int node, double admit );
         void stampSingAdm( double admit );
 
         void createCurrent();
-        inline void stampCurrent( double data ) { if( m_enode ) m_enode->stampCurrent( this, data ); }
+        inline void stampCurrent( double data ) { if( m_enode ) m_enode->stampCurrent( m_currSlot, data ); }
         
         QString getId()  { return m_id; }
         void setId( QString id );
@@ -47,10 +48,16 @@ class ePin
 
         void setIndex( int i ) { m_index = i; }
 
+        void clearSlots() { m_admitSlot = m_singSlot = m_currSlot = NULL; }
+
     protected:
         eNode* m_enode;     // My eNode
         eNode* m_enodeComp; // eNode at other side of my component
 
+        eNode::Connection* m_admitSlot; // My Connections in m_enode: stamps are O(1)
+        eNode::Connection* m_singSlot;
+        eNode::Connection* m_currSlot;
+
         QString m_id;
         int m_index;
 
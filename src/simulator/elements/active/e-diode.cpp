@@ -8,6 +8,7 @@
 #include <QDir>
 #include <QFile>
 #include <QDomDocument>
+#include <QDataStream>
 
 #include "e-diode.h"
 #include "e-pin.h"
@@ -20,12 +21,22 @@ QHash<QString, diodeData_t> eDiode::m_diodes;
 QHash<QString, diodeData_t> eDiode::m_zeners;
 QHash<QString, diodeData_t> eDiode::m_leds;
 
+int eDiode::m_batchType = NlBatch::newType();
+
 eDiode::eDiode( QString id )
       : eResistor( id )
 {
     m_vt = 0.025865;
     m_vzCoef = 1/m_vt;
     m_maxCur = 1;
+    m_gmStep = 0;
+
+    Simulator* sim = Simulator::self();
+    if( !sim ) return;
+    nlBatch = sim->getNlBatch( m_batchType );
+    if( nlBatch ) return;
+    nlBatch = new eDiodeBatch();
+    sim->addNlBatch( m_batchType, nlBatch );
 }
 eDiode::~eDiode(){}
 
@@ -49,17 +60,42 @@ void eDiode::stamp()
 }
 
 void eDiode::voltChanged()
+{
+    if( !newVoltPN() ) return;
+
+    double gmin = m_bAdmit*qExp( m_step );
+    if( gmin > .1 ) gmin = .1;
+
+    double eval = qExp( m_voltPN*m_vdCoef );
+
+    if( m_bkDown == 0 || m_voltPN >= 0  )  // No breakdown Diode or Forward biased Zener
+    {
+        m_admit   = m_satCur * m_vdCoef*eval + gmin;
+        m_current = m_satCur * (eval-1);
+    }else{                                 // Reverse biased Zener or Diode with breakdown
+        double expCoef = qExp( (-m_voltPN-m_zOfset)*m_vzCoef );
+        m_admit   = m_satCur * ( m_vdCoef*eval + m_vzCoef*expCoef ) + gmin;
+        m_current = m_satCur * ( eval-1 - expCoef ) ;
+    }
+    stampDiode();
+}
+
+bool eDiode::newVoltPN() // Set next m_voltPN, false if converged
 {
     double voltPN = m_ePin[0]->getVoltage() - m_ePin[1]->getVoltage();
 
     if( m_changed ) m_changed = false;
-    else if( qFabs( voltPN - m_voltPN ) < .01 ) { m_step = 0; m_converged = true; return; } // Converged
+    else if( qFabs( voltPN - m_voltPN ) < .01 ) // Converged
+    {
+        m_step = 0;
+        m_converged = true;
+        nlConverged();
+        return false;
+    }
     m_converged = false;
     Simulator::self()->notCorverged();
 
     m_step += .01;
-    double gmin = m_bAdmit*qExp( m_step );
-    if( gmin > .1 ) gmin = .1;
 
     if( voltPN > m_vCriti && qFabs(voltPN - m_voltPN) > m_vScale*2 ) // check new voltage; has current changed by factor of e^2?
     {
@@ -75,25 +111,29 @@ void eDiode::voltChanged()
         voltPN = -(voltPN+m_zOfset);
     }
     m_voltPN = voltPN;
+    return true;
+}
 
-    double eval = qExp( voltPN*m_vdCoef );
-
-    if( m_bkDown == 0 || voltPN >= 0  )  // No breakdown Diode or Forward biased Zener
-    {
-        m_admit   = m_satCur * m_vdCoef*eval + gmin;
-        m_current = m_satCur * (eval-1);
-    }else{                               // Reverse biased Zener or Diode with breakdown
-        double expCoef = qExp( (-voltPN-m_zOfset)*m_vzCoef );
-        m_admit   = m_satCur * ( m_vdCoef*eval + m_vzCoef*expCoef ) + gmin;
-        m_current = m_satCur * ( eval-1 - expCoef ) ;
-    }
+void eDiode::stampDiode()
+{
     eResistor::stampAdmit();
 
-    double stCurr = m_current - m_admit*voltPN;
+    double stCurr = m_current - m_admit*m_voltPN;
     m_ePin[0]->stampCurrent(-stCurr );
     m_ePin[1]->stampCurrent( stCurr );
 }
 
+bool eDiode::saveState( QDataStream& out )
+{
+    out << m_voltPN << m_admit << m_current << m_step << m_converged;
+    return true;
+}
+
+void eDiode::loadState( QDataStream& in )
+{
+    in >> m_voltPN >> m_admit >> m_current >> m_step >> m_converged;
+}
+
 inline double eDiode::limitStep( double vnew, double vold, double scale, double vc )
 {
     if( vold > 0 )
@@ -152,6 +192,7 @@ void eDiode::updateValues()
     m_zOfset = m_bkDown - m_vt*qLn(-(1-0.005/m_satCur) );
     m_vzCrit = m_vt*qLn( m_vt/(qSqrt(2)*m_satCur) );
     m_bAdmit = m_satCur*1e-2;
+    m_gmStep = (m_bAdmit > 0) ? qLn( .1/m_bAdmit ) : 0;
     m_changed = true;
 }
 
@@ -212,3 +253,64 @@ void eDiode::setModelData( diodeData_t data )
     SetParameters( data.satCur*1e-9, data.emCoef, data.brkDow, data.resist );
 }
 
+// ---- Batch evaluation ---------------------------------------
+
+void eDiodeBatch::add( eElement* el )
+{
+    eDiode* d = static_cast<eDiode*>( el );
+
+    if( d->m_bkDown != 0 ) { d->voltChanged(); return; } // Breakdown model not batched
+    if( !d->newVoltPN() ) return;
+
+    double expArg = d->m_voltPN*d->m_vdCoef;
+    if     ( expArg > 709 ) expArg = 709;    // vExp() range
+    else if( expArg <-708 ) expArg =-708;
+    double gmStep = d->m_step;
+    if( gmStep > d->m_gmStep ) gmStep = d->m_gmStep;
+
+    m_elements.push_back( d );
+    m_expArg.push_back( expArg );
+    m_gmStep.push_back( gmStep );
+    m_satCur.push_back( d->m_satCur );
+    m_vdCoef.push_back( d->m_vdCoef );
+    m_bAdmit.push_back( d->m_bAdmit );
+}
+
+void eDiodeBatch::run()
+{
+    int size = m_elements.size();
+    if( !size ) return;
+
+    m_admit.resize( size );
+    m_current.resize( size );
+
+    evaluate( size, m_expArg.data(), m_gmStep.data(), m_satCur.data(), m_vdCoef.data()
+            , m_bAdmit.data(), m_admit.data(), m_current.data() );
+
+    for( int i=0; i<size; ++i )
+    {
+        eDiode* d = m_elements[i];
+        d->m_admit   = m_admit[i];
+        d->m_current = m_current[i];
+        d->stampDiode();
+    }
+    m_elements.clear();  // Keep capacity for next run
+    m_expArg.clear();
+    m_gmStep.clear();
+    m_satCur.clear();
+    m_vdCoef.clear();
+    m_bAdmit.clear();
+}
+
+void eDiodeBatch::evaluate( int size, const double* __restrict expArg, const double* __restrict gmStep
+                          , const double* __restrict satCur, const double* __restrict vdCoef
+                          , const double* __restrict bAdmit, double* __restrict admit, double* __restrict current )
+{
+    for( int i=0; i<size; ++i ) // No calls, branches or aliasing: vectorized
+    {
+        double eval = vExp( expArg[i] );
+        double gmin = bAdmit[i]*vExp( gmStep[i] );
+        admit[i]   = satCur[i]*vdCoef[i]*eval + gmin;
+        current[i] = satCur[i]*(eval-1);
+    }
+}
@@ -7,8 +7,10 @@
 #define EDIODE_H
 
 #include <QHash>
+#include <vector>
 
 #include "e-resistor.h"
+#include "nlbatch.h"
 
 struct diodeData_t
 {
@@ -19,9 +21,33 @@ struct diodeData_t
 };
 
 class eNode;
+class eDiode;
+
+class eDiodeBatch : public NlBatch  // Diodes without breakdown
+{
+    public:
+        virtual void add( eElement* el ) override;
+        virtual void run() override;
+
+    private:
+ static void evaluate( int size, const double* __restrict expArg, const double* __restrict gmStep
+                     , const double* __restrict satCur, const double* __restrict vdCoef
+                     , const double* __restrict bAdmit, double* __restrict admit, double* __restrict current );
+
+        std::vector<eDiode*> m_elements;
+        std::vector<double>  m_expArg;  // voltPN*vdCoef
+        std::vector<double>  m_gmStep;
+        std::vector<double>  m_satCur;
+        std::vector<double>  m_vdCoef;
+        std::vector<double>  m_bAdmit;
+        std::vector<double>  m_admit;
+        std::vector<double>  m_current;
+};
 
 class eDiode : public eResistor
 {
+    friend class eDiodeBatch;
+
     public:
         eDiode( QString id );
         ~eDiode();
@@ -29,6 +55,9 @@ class eDiode : public eResistor
         virtual void stamp() override;
         virtual void voltChanged() override;
 
+        virtual bool saveState( QDataStream& out ) override;
+        virtual void loadState( QDataStream& in ) override;
+
         double threshold() { return m_vCriti; }
         void   setThreshold( double vCrit );
 
@@ -51,6 +80,11 @@ class eDiode : public eResistor
  static void getModels();
 
     protected:
+        virtual void nlConverged(){;}  // Called when voltage converged
+
+        bool newVoltPN();
+        void stampDiode();
+
         double limitStep( double vnew, double vold, double scale, double vc );
         void SetParameters( double sc, double ec, double bv, double sr );
         void updateValues();
@@ -72,6 +106,7 @@ class eDiode : public eResistor
 
         double m_voltPN;
         double m_bAdmit;
+        double m_gmStep; // Max m_step for gmin < 0.1
 
         QString m_diodeType;
         QString m_model;
@@ -79,6 +114,8 @@ class eDiode : public eResistor
  static QHash<QString, diodeData_t> m_diodes;
  static QHash<QString, diodeData_t> m_zeners;
  static QHash<QString, diodeData_t> m_leds;
+
+ static int m_batchType;
 };
 
 #endif
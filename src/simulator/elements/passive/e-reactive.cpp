@@ -3,10 +3,14 @@
  *                                                                         *
  ***( see copyright.txt file at root folder )*******************************/
 
+#include <math.h>
+#include <QDataStream>
+
 #include "e-reactive.h"
 #include "e-pin.h"
 #include "e-node.h"
 #include "simulator.h"
+#include "acanalysis.h"
 
 eReactive::eReactive( QString id )
          : eResistor( id )
@@ -15,6 +19,21 @@ eReactive::eReactive( QString id )
     m_reacStep = 0;
     m_InitCurr = 0;
     m_InitVolt = 0;
+    m_volt = 0;
+    m_curSource = 0;
+    m_tStep = 0;
+    m_hist  = 0;
+    m_deriv = 0;
+    m_x0 = m_x1 = m_x2 = m_x3 = 0;
+    m_h0 = m_h1 = m_h2 = 0;
+    m_xPeak = 0;
+    m_tol   = 1e-3;
+    m_timeStep = 0;
+    m_stepMin  = 0;
+    m_stepMax  = 0;
+    m_integ = REACT_EULER;
+    m_adapt = false;
+    m_running = false;
 }
 eReactive::~eReactive(){}
 
@@ -27,17 +46,13 @@ void eReactive::stamp()
         m_ePin[0]->createCurrent();
         m_ePin[1]->createCurrent();
 
-        updtReactStep();
+        m_x0 = initState();
+        m_xPeak = fabs( m_x0 );
+        m_volt  = m_InitVolt;
+        m_curSource = 0;
 
-        m_volt = m_InitVolt;
-        m_curSource = m_InitCurr;
-        m_curSource = updtCurr();
+        updtReactStep();
 
-        if( m_curSource )
-        {
-            m_ePin[0]->stampCurrent( m_curSource );
-            m_ePin[1]->stampCurrent(-m_curSource );
-        }
         m_ePin[0]->changeCallBack( this );
         m_ePin[1]->changeCallBack( this );
     }
@@ -48,31 +63,186 @@ void eReactive::voltChanged()
 {
     if( m_running ) return;
     m_running = true;
+
+    m_x1 = m_x2 = m_x3 = m_x0; // Restart from steady state
+    m_deriv = 0;
+    if( m_adapt ) m_timeStep = m_stepMin; // Fast edge: start with min step
+    m_h0 = m_h1 = m_h2 = (double)m_timeStep/1e12;
+    if( m_adapt ) updtCompanion( false );
+
     Simulator::self()->addEvent( m_timeStep, this );
 }
 
 void eReactive::runEvent()
 {
     double volt = m_ePin[0]->getVoltage() - m_ePin[1]->getVoltage();
+    double state = getState( volt );
+
+    m_deriv = (state-m_hist)/m_tStep;
+    m_x3 = m_x2; m_x2 = m_x1; m_x1 = m_x0; m_x0 = state;
+    m_h2 = m_h1; m_h1 = m_h0; m_h0 = (double)m_timeStep/1e12;
+
+    double absX = fabs( state );
+    if( absX > m_xPeak ) m_xPeak = absX;
+
+    bool steady;
+    if( !m_adapt && m_integ == REACT_EULER ) steady = (volt == m_volt); // Default: same as before adaptive step
+    else{
+        double rest = 1e-9*m_xPeak;
+        steady = fabs( m_x0-m_x1 ) <= rest && fabs( m_deriv*m_h0 ) <= rest;
+    }
+    m_volt = volt;
 
-    if( m_volt != volt )
+    if( steady ) // Steady state
     {
-        m_volt = volt;
-        m_curSource = updtCurr();
+        m_running = false;
+        return;
+    }
+    if( m_adapt ) updtStep();
+    updtCompanion( false );
 
+    Simulator::self()->addEvent( m_timeStep, this );
+}
+
+void eReactive::setOpPoint( bool op ) // Capacitor open, Inductor short
+{
+    if( !m_ePin[0]->isConnected() || !m_ePin[1]->isConnected() ) return;
+
+    if( op ){
+        m_running = true;  // Don't schedule steps while solving DC
+        m_tStep = 1e9;     // Very long step: Capacitor ~0 admitance, Inductor ~0 resistance
+        m_hist  = 0;
+        eResistor::setRes( updtRes() );
+        m_curSource = updtCurr();
         m_ePin[0]->stampCurrent( m_curSource );
         m_ePin[1]->stampCurrent(-m_curSource );
-        Simulator::self()->addEvent( m_timeStep, this );
+    }else{
+        double volt = m_ePin[0]->getVoltage() - m_ePin[1]->getVoltage();
+        m_x0 = getState( volt ); // Start transient from DC state
+        m_volt = volt;
+        m_xPeak = fabs( m_x0 );
+        updtReactStep();
     }
-    else m_running = false;
+}
+
+void eReactive::stampAc( AcAnalysis* ac, double omega ) // Replace companion admitance
+{
+    if( !m_ePin[0]->isConnected() || !m_ePin[1]->isConnected() ) return;
+
+    ac->addAdmit( m_ePin[0]->getEnode(), m_ePin[1]->getEnode(), acAdmit( omega )-m_admit );
+}
+
+bool eReactive::saveState( QDataStream& out )
+{
+    out << m_admit << m_curSource << m_tStep << m_hist << m_deriv << m_x0 << m_x1 << m_x2 << m_x3
+        << m_h0 << m_h1 << m_h2 << m_xPeak << (quint64)m_timeStep << m_running << m_volt;
+    return true;
+}
+
+void eReactive::loadState( QDataStream& in )
+{
+    quint64 timeStep;
+    in >> m_admit >> m_curSource >> m_tStep >> m_hist >> m_deriv >> m_x0 >> m_x1 >> m_x2 >> m_x3
+       >> m_h0 >> m_h1 >> m_h2 >> m_xPeak >> timeStep >> m_running >> m_volt;
+    m_timeStep = timeStep;
+}
+
+void eReactive::updtCompanion( bool newRes ) // Companion model for next step
+{
+    double h = (double)m_timeStep/1e12;
+    double tStep;
+
+    switch( m_integ )
+    {
+        case REACT_TRAPEZ:
+        {
+            tStep  = h/2;
+            m_hist = m_x0 + tStep*m_deriv;
+        } break;
+        case REACT_GEAR2:  // Variable step BDF2: dx/dt = a0*x + a1*x0 + a2*x1
+        {
+            double hp = m_h0;
+            double a0 = (2*h+hp)/(h*(h+hp));
+            double a1 =-(h+hp)/(h*hp);
+            double a2 = h/(hp*(h+hp));
+            tStep  = 1/a0;
+            m_hist = -(a1*m_x0 + a2*m_x1)/a0;
+        } break;
+        default:           // Backward Euler
+        {
+            tStep  = h;
+            m_hist = m_x0;
+        }
+    }
+    if( newRes || tStep != m_tStep )
+    {
+        m_tStep = tStep;
+        eResistor::setRes( updtRes() );
+    }
+    double curSource = updtCurr();
+    if( curSource == m_curSource ) return;
+    m_curSource = curSource;
+
+    m_ePin[0]->stampCurrent( m_curSource );
+    m_ePin[1]->stampCurrent(-m_curSource );
+}
+
+void eReactive::updtStep() // Next step size from local truncation error
+{
+    // Step is only doubled or halved, so the admitance takes a few values
+    // and the matrix factorizations can be reused.
+    double d1a = (m_x0-m_x1)/m_h0;        // Divided differences
+    double d1b = (m_x1-m_x2)/m_h1;
+    double d2a = (d1a-d1b)/(m_h0+m_h1);
+
+    double h = m_h0;
+    double error;
+    double grow;
+
+    if( m_integ == REACT_EULER )         // LTE = h²/2*x''
+    {
+        error = h*h*d2a;
+        grow  = 4;                       // Error increase if step doubled
+    }else{                               // LTE = C*h³*x'''
+        double d1c = (m_x2-m_x3)/m_h2;
+        double d2b = (d1b-d1c)/(m_h1+m_h2);
+        double d3  = (d2a-d2b)/(m_h0+m_h1+m_h2);
+        double c = (m_integ == REACT_TRAPEZ) ? 1.0/12 : 2.0/9;
+        error = c*6*h*h*h*d3;
+        grow  = 8;
+    }
+    error = fabs( error );
+    double tol = m_tol*( fabs( m_x0 )+1e-3*m_xPeak );
+
+    if( error > tol )
+    {
+        while( error > tol && m_timeStep/2 >= m_stepMin )
+        {
+            m_timeStep /= 2;
+            error /= grow;
+        }
+    }
+    else if( error*grow < tol/2 && m_timeStep*2 <= m_stepMax ) m_timeStep *= 2;
 }
 
 void eReactive::updtReactStep()
 {
-    if( m_reacStep ) m_timeStep = m_reacStep;
-    else             m_timeStep = Simulator::self()->reactStep(); // Time in ps
-    m_tStep = (double)m_timeStep/1e12;         // Time in seconds
-    eResistor::setRes( updtRes() );
+    Simulator* sim = Simulator::self();
+    m_integ   = sim->reactInteg();
+    m_adapt   = sim->reactAdapt() && !m_reacStep; // Step set in component: fixed step
+    m_stepMin = sim->reactStepMin();
+    m_stepMax = sim->reactStepMax();
+    if( m_stepMax < m_stepMin ) m_stepMax = m_stepMin;
+    m_tol     = sim->reactTol();
+
+    if     ( m_reacStep ) m_timeStep = m_reacStep;
+    else if( m_adapt    ) m_timeStep = m_stepMin;
+    else                  m_timeStep = sim->reactStep(); // Time in ps
+
+    m_x1 = m_x2 = m_x3 = m_x0;
+    m_h0 = m_h1 = m_h2 = (double)m_timeStep/1e12; // Time in seconds
+    m_deriv = 0;
+    updtCompanion( true );
 
     m_running = false;
     Simulator::self()->cancelEvents( this );
@@ -6,6 +6,8 @@
 #ifndef EREACTIVE_H
 #define EREACTIVE_H
 
+#include <complex>
+
 #include "e-resistor.h"
 
 class eReactive : public eResistor
@@ -18,6 +20,13 @@ class eReactive : public eResistor
         virtual void voltChanged() override;
         virtual void runEvent() override;
 
+        virtual void setOpPoint( bool op ) override;
+
+        virtual void stampAc( AcAnalysis* ac, double omega ) override;
+
+        virtual bool saveState( QDataStream& out ) override;
+        virtual void loadState( QDataStream& in ) override;
+
         double initVolt() { return m_InitVolt; }
         void setInitVolt( double v ) { m_InitVolt = v; }
 
@@ -26,9 +35,14 @@ class eReactive : public eResistor
 
     protected:
         void updtReactStep();
+        void updtCompanion( bool newRes );
+        void updtStep();
 
-        virtual double updtRes(){ return 0.0;}
-        virtual double updtCurr(){ return 0.0;}
+        virtual double updtRes(){ return 0.0;}  // Resistance of companion model for m_tStep
+        virtual double updtCurr(){ return 0.0;} // Current source of companion model for m_hist
+        virtual double getState( double volt ){ return 0.0;} // Capacitor voltage or Inductor current
+        virtual double initState(){ return 0.0;}
+        virtual std::complex<double> acAdmit( double omega ){ return m_admit; } // Admitance at frequency omega (rad/s)
 
         double m_value; // Capacitance or Inductance
 
@@ -36,13 +50,24 @@ class eReactive : public eResistor
         double m_curSource;
 
         double m_InitVolt;
-        double m_volt;
+        double m_volt;    // Voltage at last step: fixed step Backward Euler stops when it doesn't change
+
+        double m_tStep;   // Effective step of integration method (s)
+        double m_hist;    // State term of companion model: State = m_tStep*dState/dt + m_hist
+        double m_deriv;   // dState/dt at last step
 
-        double m_tStep;
+        double m_x0, m_x1, m_x2, m_x3; // State at last steps (m_x0 = newest)
+        double m_h0, m_h1, m_h2;       // Last step sizes (s)
+        double m_xPeak;
+        double m_tol;
 
         uint64_t m_reacStep;
         uint64_t m_timeStep;
+        uint64_t m_stepMin;
+        uint64_t m_stepMax;
 
+        int  m_integ;
+        bool m_adapt;
         bool m_running;
 };
 
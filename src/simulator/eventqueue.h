@@ -0,0 +1,114 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include <vector>
+#include <cstdint>
+
+#include "e-element.h"
+
+// Binary heap of pending events keyed on eElement::eventTime.
+// Each eElement stores its slot in the heap (eventIndex), so cancel is O(log n).
+// Events with the same time run last-added first (same as the old sorted list).
+
+class EventQueue
+{
+    public:
+        EventQueue(){ m_order = 0; m_peak = 0; }
+        ~EventQueue(){;}
+
+        inline eElement* first() { return m_heap.empty() ? nullptr : m_heap[0]; }
+        inline int size() { return m_heap.size(); }
+        inline int peak() { return m_peak; } // Max size since clear()
+
+        inline void insert( eElement* el, uint64_t time )
+        {
+            el->eventTime  = time;
+            el->eventOrder = ++m_order;
+            el->eventIndex = m_heap.size();
+            m_heap.push_back( el );
+            siftUp( el->eventIndex );
+            if( (int)m_heap.size() > m_peak ) m_peak = m_heap.size();
+        }
+
+        inline void pop() { remove( m_heap[0] ); }
+
+        inline void remove( eElement* el )
+        {
+            int i = el->eventIndex;
+            if( i < 0 ) return;
+            el->eventIndex = -1;
+
+            eElement* last = m_heap.back();
+            m_heap.pop_back();
+            if( last == el ) return; // Was the last one
+
+            m_heap[i] = last;
+            last->eventIndex = i;
+            if( i > 0 && before( last, m_heap[(i-1)/2] ) ) siftUp( i );
+            else                                           siftDown( i );
+        }
+
+        void clear()
+        {
+            for( eElement* el : m_heap ){
+                el->eventIndex = -1;
+                el->eventTime  = 0;
+            }
+            m_heap.clear();
+            m_order = 0;
+            m_peak  = 0;
+        }
+
+    private:
+        inline bool before( eElement* a, eElement* b ) // a must run before b
+        {
+            if( a->eventTime != b->eventTime ) return a->eventTime < b->eventTime;
+            return a->eventOrder > b->eventOrder;   // Same time: last added first
+        }
+
+        inline void siftUp( int i )
+        {
+            eElement* el = m_heap[i];
+            while( i > 0 )
+            {
+                int parent = (i-1)/2;
+                eElement* p = m_heap[parent];
+                if( !before( el, p ) ) break;
+                m_heap[i] = p;
+                p->eventIndex = i;
+                i = parent;
+            }
+            m_heap[i] = el;
+            el->eventIndex = i;
+        }
+
+        inline void siftDown( int i )
+        {
+            int n = m_heap.size();
+            eElement* el = m_heap[i];
+            while( true )
+            {
+                int child = 2*i+1;
+                if( child >= n ) break;
+                if( child+1 < n && before( m_heap[child+1], m_heap[child] ) ) child++;
+                eElement* c = m_heap[child];
+                if( !before( c, el ) ) break;
+                m_heap[i] = c;
+                c->eventIndex = i;
+                i = child;
+            }
+            m_heap[i] = el;
+            el->eventIndex = i;
+        }
+
+        std::vector<eElement*> m_heap;
+
+        uint64_t m_order;
+        int m_peak;
+};
+#endif
@@ -0,0 +1,65 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef NLBATCH_H
+#define NLBATCH_H
+
+#include <stdint.h>
+
+class eElement;
+
+// Non Linear elements of the same type evaluated together.
+// If batching is enabled, Simulator adds elements with a NlBatch to it
+// instead of calling voltChanged(), and runs the batches at the end of
+// each node group pass. Batches keep element data in arrays (one per value)
+// so the math loops can be vectorized by the compiler.
+
+class NlBatch
+{
+    public:
+        NlBatch() { nextBatch = nullptr; queued = false; }
+        virtual ~NlBatch(){;}
+
+        virtual void add( eElement* el )=0;
+        virtual void run()=0;  // Evaluate and stamp all elements added, then clear
+
+        NlBatch* nextBatch;
+        bool queued;
+
+        // Each Simulator has it's own batches: Simulator::getNlBatch( type )
+        static int newType() { static int types = 0; return types++; }
+
+        // exp() without calls or branches, so loops using it can be vectorized.
+        // x must be in [-708, 709] (clamp it when filling the arrays).
+        // Relative error < 5e-16.
+        static inline double vExp( double x )
+        {
+            int k = (int)( x*1.4426950408889634 + 1024.5 ) - 1024; // Round x/ln(2): x/ln(2)+1024.5 > 0
+            double kd = k;
+
+            double r = x - kd*6.93147180369123816490e-01 // x - k*ln(2) in two parts
+                         - kd*1.90821492927058770002e-10;
+
+            double p = 1.0/479001600;                    // Taylor up to r^12, |r| <= ln(2)/2
+            p = p*r + 1.0/39916800;
+            p = p*r + 1.0/3628800;
+            p = p*r + 1.0/362880;
+            p = p*r + 1.0/40320;
+            p = p*r + 1.0/5040;
+            p = p*r + 1.0/720;
+            p = p*r + 1.0/120;
+            p = p*r + 1.0/24;
+            p = p*r + 1.0/6;
+            p = p*r + 0.5;
+            p = p*r + 1.0;
+            p = p*r + 1.0;
+
+            union { int64_t i; double d; } scale;        // 2^k
+            scale.i = (int64_t)(k + 1023) << 52;
+            return p*scale.d;
+        }
+};
+
+#endif
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include "simdkernels.h"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+  #define SIMD_X86
+  #include <immintrin.h>
+#endif
+
+static void subScaledScalar( double* y, const double* x, double a, int n )
+{
+    for( int i=0; i<n; ++i ) y[i] -= a*x[i];
+}
+
+static double dotProdScalar( const double* a, const double* b, int n )
+{
+    double tot = 0;
+    for( int i=0; i<n; ++i ) tot += a[i]*b[i];
+    return tot;
+}
+
+#ifdef SIMD_X86
+__attribute__((target("sse2")))
+static void subScaledSse2( double* y, const double* x, double a, int n )
+{
+    __m128d va = _mm_set1_pd( a );
+    int i = 0;
+    for( ; i+2<=n; i+=2 )
+    {
+        __m128d vy = _mm_loadu_pd( y+i );
+        __m128d vx = _mm_loadu_pd( x+i );
+        _mm_storeu_pd( y+i, _mm_sub_pd( vy, _mm_mul_pd( va, vx ) ) );
+    }
+    for( ; i<n; ++i ) y[i] -= a*x[i];
+}
+
+__attribute__((target("sse2")))
+static double dotProdSse2( const double* a, const double* b, int n )
+{
+    __m128d acc = _mm_setzero_pd();
+    int i = 0;
+    for( ; i+2<=n; i+=2 )
+        acc = _mm_add_pd( acc, _mm_mul_pd( _mm_loadu_pd( a+i ), _mm_loadu_pd( b+i ) ) );
+
+    double tmp[2];
+    _mm_storeu_pd( tmp, acc );
+    double tot = tmp[0]+tmp[1];
+    for( ; i<n; ++i ) tot += a[i]*b[i];
+    return tot;
+}
+
+__attribute__((target("avx2")))
+static void subScaledAvx2( double* y, const double* x, double a, int n )
+{
+    __m256d va = _mm256_set1_pd( a );
+    int i = 0;
+    for( ; i+4<=n; i+=4 )
+    {
+        __m256d vy = _mm256_loadu_pd( y+i );
+        __m256d vx = _mm256_loadu_pd( x+i );
+        _mm256_storeu_pd( y+i, _mm256_sub_pd( vy, _mm256_mul_pd( va, vx ) ) );
+    }
+    for( ; i<n; ++i ) y[i] -= a*x[i];
+}
+
+__attribute__((target("avx2")))
+static double dotProdAvx2( const double* a, const double* b, int n )
+{
+    __m256d acc = _mm256_setzero_pd();
+    int i = 0;
+    for( ; i+4<=n; i+=4 )
+        acc = _mm256_add_pd( acc, _mm256_mul_pd( _mm256_loadu_pd( a+i ), _mm256_loadu_pd( b+i ) ) );
+
+    double tmp[4];
+    _mm256_storeu_pd( tmp, acc );
+    double tot = (tmp[0]+tmp[1])+(tmp[2]+tmp[3]);
+    for( ; i<n; ++i ) tot += a[i]*b[i];
+    return tot;
+}
+#endif
+
+subScaled_t SimdKernels::subScaled = subScaledScalar;
+dotProd_t   SimdKernels::dotProd   = dotProdScalar;
+const char* SimdKernels::m_name    = "Scalar";
+
+void SimdKernels::initKernels()
+{
+    subScaled = subScaledScalar;
+    dotProd   = dotProdScalar;
+    m_name    = "Scalar";
+
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports("avx2") )
+    {
+        subScaled = subScaledAvx2;
+        dotProd   = dotProdAvx2;
+        m_name    = "AVX2";
+    }
+    else if( __builtin_cpu_supports("sse2") )
+    {
+        subScaled = subScaledSse2;
+        dotProd   = dotProdSse2;
+        m_name    = "SSE2";
+    }
+#endif
+}
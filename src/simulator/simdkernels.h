@@ -0,0 +1,28 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+// Vector kernels used by CircMatrix dense LU.
+// initKernels() selects AVX2, SSE2 or scalar versions at runtime.
+
+typedef void   (*subScaled_t)( double* y, const double* x, double a, int n ); // y[i] -= a*x[i]
+typedef double (*dotProd_t)( const double* a, const double* b, int n );      // sum a[i]*b[i]
+
+class SimdKernels
+{
+    public:
+ static void initKernels();
+ static const char* name() { return m_name; }
+
+ static subScaled_t subScaled;
+ static dotProd_t   dotProd;
+
+    private:
+ static const char* m_name;
+};
+
+#endif
@@ -5,7 +5,12 @@
 
 #include <qtconcurrentrun.h>
 #include <QHash>
+#include <QSet>
+#include <QThread>
+#include <QDataStream>
+#include <QFile>
 #include <math.h>
+#include <algorithm>
 
 #include "simulator.h"
 #include "editorwindow.h"
@@ -16,27 +21,48 @@
 #include "infowidget.h"
 #include "circuitwidget.h"
 #include "circmatrix.h"
+#include "connector.h"
 #include "e-element.h"
 #include "socket.h"
+#include "stimulus.h"
 
-Simulator* Simulator::m_pSelf = NULL;
+thread_local Simulator* Simulator::m_pSelf = NULL;
 
 Simulator::Simulator( QObject* parent )
          : QObject( parent )
 {
     m_pSelf = this;
+    m_circuit = Circuit::self();
 
+    m_nodeArenas = new eNode::Arenas();
     m_matrix = new CircMatrix();
+    m_stimulus = new Stimulus();
 
     m_fps = 20;
+    m_animFps = 5;
     m_timerId   = 0;
     m_timerTick_ms = 50;   // 50 ms default
     m_psPerSec  = 1e12;
     m_stepSize  = 1e6;
     m_stepsPS   = 1e6;
     m_reactStep = 1e6;
+    m_reactStepMin = 1e3;
+    m_reactStepMax = 1e9;
+    m_reactInteg = REACT_EULER;
+    m_reactAdapt = false;
+    m_reactTol   = 1e-3;
     m_maxNlstp  = 100000;
     m_slopeSteps = 0;
+    m_maxSpeed   = false;
+    m_dcOpPoint  = false;
+    m_nlBatch    = MainWindow::self()->settings()->value( "batchNonLinear", false ).toBool(); // Changes solve order
+    m_batchList  = NULL;
+    m_profiling  = false;
+    m_profReset  = false;
+    m_simTime    = 0;
+    m_guiRequest = false;
+    m_simParked  = false;
+    m_fastForward = false;
 
     m_errors[0] = "";
     //m_errors[1] = "Could not solve Matrix";
@@ -55,7 +81,31 @@ Simulator::Simulator( QObject* parent )
 Simulator::~Simulator()
 {
     m_CircuitFuture.waitForFinished();
+    delete m_stimulus;
     delete m_matrix;
+    for( NlBatch* batch : m_nlBatches ) delete batch;
+    for( eElement* el : m_elementList ) el->detachSim(); // Elements can outlive this Simulator
+    m_nodeArenas->unref();                               // eNodes can outlive it too
+
+    if( m_pSelf == this ) m_pSelf = NULL;
+}
+
+// Each Simulator is an independent simulation: it owns event queue, matrix,
+// eNodes and eElements. Components get the current Simulator of the thread
+// with self() when they are created, and eNodes/eElements keep it.
+// The Simulator running a circuit must be current in the thread running it.
+void Simulator::makeCurrent()
+{
+    m_pSelf = this;
+    m_matrix->makeCurrent();
+    m_stimulus->makeCurrent();
+    if( m_circuit ) m_circuit->makeCurrent();
+}
+
+void Simulator::addNlBatch( int type, NlBatch* batch )
+{
+    if( type >= (int)m_nlBatches.size() ) m_nlBatches.resize( type+1, NULL );
+    m_nlBatches[type] = batch;
 }
 
 inline void Simulator::solveMatrix()
@@ -67,6 +117,7 @@ inline void Simulator::solveMatrix()
     //if( !m_matrix->solveMatrix() ) // m_matrix sets the eNode voltages
     //    m_warning = 2;             // Warning if diagonal element = 0.
     m_matrix->solveMatrix(); // m_matrix sets the eNode voltages
+    m_matrixSolves++;
 }
 
 void Simulator::timerEvent( QTimerEvent* e )  //update at m_timerTick_ms rate (50 ms, 20 Hz max)
@@ -95,7 +146,9 @@ void Simulator::timerEvent( QTimerEvent* e )  //update at m_timerTick_ms rate (5
     else if( m_warning < 0 )
     { if( ++m_warning == 0 ) CircuitWidget::self()->setMsg( " "+tr("Running")+" ", 0 ); }
 
-    if( !m_CircuitFuture.isFinished() ) // Stop remaining parallel thread
+    bool continuous = m_maxSpeed && m_state == SIM_RUNNING;
+    if( continuous ) holdCircuit();     // Max speed: just stop thread at a safe point
+    else if( !m_CircuitFuture.isFinished() ) // Stop remaining parallel thread
     {
         simState_t state = m_state;
         m_state = SIM_WAITING;
@@ -103,29 +156,56 @@ void Simulator::timerEvent( QTimerEvent* e )  //update at m_timerTick_ms rate (5
         m_state = state;
     }
 
-    for( Updatable* el : m_updateList ) el->updateStep();
+    // Simulation is stopped here: publish state to front buffers
+    if( m_profReset ) clearProfile();
+
+    bool showStats = InfoWidget::self()->statsVisible() && (m_timerTime-m_lastRefT) >= 1e9; // With Real Speed
+    simStats_t stats;
+    if( showStats ) stats = this->stats();
+
+    bool animate = Circuit::self()->animate() && (m_timerTime-m_updtTime) >= 1e9/m_animFps;
+    if( animate ) takeNodeSnapshots();
+
+    m_frontList.clear();
+    for( Updatable* el : m_updateList )
+    {
+        if( el->hasSnapshot() ){
+            el->takeSnapshot();
+            m_frontList.append( el );
+        }
+        else el->updateStep(); // Reads simulation state directly
+    }
     EditorWindow::self()->outPane()->updateStep(); // OutPanel in Editor can be created before this simulator.
 
     // Calculate Simulation Load
-    double timer_ns = m_timerTick_ms*1e6;
-    uint64_t simLoop = 0;
-    if( m_loopTime > m_refTime ) simLoop = m_loopTime-m_refTime;
-    m_simLoad = (m_simLoad+100*simLoop/timer_ns)/2;
-
+    if( continuous ) m_simLoad = 100;
+    else{
+        double timer_ns = m_timerTick_ms*1e6;
+        uint64_t simLoop = 0;
+        if( m_loopTime > m_refTime ) simLoop = m_loopTime-m_refTime;
+        m_simLoad = (m_simLoad+100*simLoop/timer_ns)/2;
+    }
     // Get Simulation times
-    m_simPsPF = m_circTime-m_tStep;
-    m_tStep   = m_circTime;
+    uint64_t simTime = this->simTime();
+    m_simPsPF = simTime-m_tStep;
+    m_tStep   = simTime;
 
-    if( m_state == SIM_RUNNING ) // Run Circuit in a parallel thread
+    if( continuous )             // Simulation thread keeps running between frames
+    {
+        releaseCircuit();
+        if( m_CircuitFuture.isFinished() )
+            m_CircuitFuture = QtConcurrent::run( this, &Simulator::runContinuous );
+    }
+    else if( m_state == SIM_RUNNING ) // Run Circuit in a parallel thread
         m_CircuitFuture = QtConcurrent::run( this, &Simulator::runCircuit );
 
-    if( Circuit::self()->animate() ) // Moved here to be in parallel with runCircuit thread
+    // In parallel with runCircuit thread: only front buffers are read from here
+    for( Updatable* el : m_frontList ) el->updateStep();
+
+    if( animate )
     {
-        if( (m_timerTime-m_updtTime) >= 2e8 ){ // Animate at 5 FPS
-            //Circuit::self()->updateConnectors();
-            for( eNode* node : m_eNodeList) node->updateConnectors();
-            m_updtTime = m_timerTime;
-        }
+        updateConnectors();
+        m_updtTime = m_timerTime;
     }
     // Calculate Real Simulation Speed
     m_refTime  = m_RefTimer.nsecsElapsed();
@@ -141,19 +221,28 @@ void Simulator::timerEvent( QTimerEvent* e )  //update at m_timerTick_ms rate (5
         m_lastRefT = m_refTime;
     }
     InfoWidget::self()->setCircTime( m_tStep );
+    if( showStats ) InfoWidget::self()->setStats( stats );
 
     m_guiTime += m_RefTimer.nsecsElapsed()-m_timerTime; // Time in this function
 }
 
 void Simulator::runCircuit()
 {
+    makeCurrent();  // Can run in any thread
+
     solveCircuit(); // Solve any pending changes
     if( m_state < SIM_RUNNING ) return;
 
-    eElement* event = m_firstEvent;
+    eElement* event = m_eventQueue.first();
     uint64_t endRun = m_circTime + m_psPF; // Run upto next Timer event
     uint64_t nextTime;
 
+    if( m_fastForward && event && event->eventTime > endRun && idle() ) // Nothing to do before next event
+    {
+        endRun = event->eventTime;            // Jump there, no frame pacing
+        m_idleSkips++;
+    }
+
     while( event )                              // Simulator event loop
     {
         if( event->eventTime > endRun ) break;  // All events for this Timer Tick are done
@@ -162,52 +251,172 @@ void Simulator::runCircuit()
         while( m_circTime == nextTime )         // Run all event with same timeStamp
         {
             m_circTime = event->eventTime;
-            m_firstEvent = event->nextEvent;    // free Event
-            event->nextEvent = NULL;
+            m_eventQueue.pop();                 // free Event
             event->eventTime = 0;
-            event->runEvent();                  // Run event callback
-            event = m_firstEvent;
+            if( m_profiling ) profileEvent( event );
+            else              event->runEvent();  // Run event callback
+            m_eventCount++;
+            event = m_eventQueue.first();
             if( event ) nextTime = event->eventTime;
             else break;
         }
         solveCircuit();
         if( m_state < SIM_RUNNING ) break;
-        event = m_firstEvent;               // m_firstEvent can be an event added at solveCircuit()
+        if( m_guiRequest.load( std::memory_order_relaxed ) ) guiSync();
+        event = m_eventQueue.first();           // First event can be an event added at solveCircuit()
     }
     if( m_state > SIM_WAITING ) m_circTime = endRun;
+    m_simTime.store( m_circTime, std::memory_order_relaxed );
     m_loopTime = m_RefTimer.nsecsElapsed();
 }
 
+void Simulator::runContinuous() // Max speed: run frame after frame until stopped
+{
+    m_fastForward = true;
+    while( m_state == SIM_RUNNING && m_maxSpeed )
+    {
+        runCircuit();
+        if( m_guiRequest.load( std::memory_order_relaxed ) ) guiSync();
+    }
+    m_fastForward = false;
+}
+
+void Simulator::guiSync() // Simulation thread: wait here while GUI reads circuit state
+{
+    QMutexLocker locker( &m_syncMutex );
+    m_simTime.store( m_circTime, std::memory_order_relaxed );
+    m_simParked = true;
+    m_syncCond.wakeAll();
+    while( m_guiRequest ) m_syncCond.wait( &m_syncMutex );
+    m_simParked = false;
+}
+
+void Simulator::holdCircuit() // GUI thread: stop simulation thread at next safe point
+{
+    QMutexLocker locker( &m_syncMutex );
+    m_guiRequest = true;
+    while( !m_simParked && !m_CircuitFuture.isFinished() ) m_syncCond.wait( &m_syncMutex, 1 );
+}
+
+void Simulator::releaseCircuit()
+{
+    QMutexLocker locker( &m_syncMutex );
+    m_guiRequest = false;
+    m_syncCond.wakeAll();
+}
+
 void Simulator::solveCircuit()
 {
-    while( m_changedNode || m_nonLinear || !m_converged ) // Also Proccess changes gererated in voltChanged()
+    while( m_changedNode || !m_nlActive.empty() || !m_converged ) // Also Proccess changes gererated in voltChanged()
     {
         if( m_changedNode ) solveMatrix();
 
-        if( m_converged ) m_converged = m_nonLinear==NULL;
-        while( !m_converged )              // Non Linear Components
+        m_converged = true;
+        while( !m_nlActive.empty() )       // Non Linear Components: each node group converges by itself
         {
-            m_converged = true;
-            while( m_nonLinear ){
-                m_nonLinear->added = false;
-                m_nonLinear->voltChanged();
-                m_nonLinear = m_nonLinear->nextChanged;
-            }
-            if( m_maxNlstp && (m_NLstep++ >= m_maxNlstp) ) { m_warning = 1; return; } // Max iterations reached
+            m_nlIterations++;
+            m_nlGroups.swap( m_nlActive );
+            for( int group : m_nlGroups ) solveNonLinear( group );
+            m_nlGroups.clear();
+
             if( m_state < SIM_RUNNING ){ m_converged = false; break; }    // Loop broken without converging
             if( m_changedNode ) solveMatrix();
         }
         if( !m_converged ) return; // Don't run linear until nonliear converged (Loop broken)
 
-        m_NLstep = 0;
+        for( int group : m_nlUsed )   // Non Linear loop ended: all groups start counting again
+            if( !m_maxNlstp || m_nlStep[group] <= m_maxNlstp ) m_nlStep[group] = 0; // Blocked groups wait until the end
+        m_nlUsed.clear();
+
         while( m_voltChanged )
         {
             m_voltChanged->added = false;
-            m_voltChanged->voltChanged();
+            if( m_profiling ) profileVoltChanged( m_voltChanged );
+            else              m_voltChanged->voltChanged();
             m_voltChanged = m_voltChanged->nextChanged;
+            m_voltChCount++;
         }
         if( m_state < SIM_RUNNING ) break;    // Loop broken without converging
     }
+    for( int group : m_nlBlocked ) m_nlStep[group] = 0; // Try again in next solveCircuit()
+    m_nlBlocked.clear();
+}
+
+inline void Simulator::solveNonLinear( int group )
+{
+    m_nlFlag[group] = 0;
+    eElement* el = m_nlList[group];
+    m_nlList[group] = NULL;
+
+    if( m_maxNlstp && m_nlStep[group] >= m_maxNlstp ) // Max iterations reached: only this group stops
+    {
+        if( m_nlStep[group] == m_maxNlstp )
+        {
+            m_nlStep[group]++;
+            m_nlFails[group]++;
+            m_nlBlocked.push_back( group );
+            if( m_nlFails[group] == 1 ) qDebug() << "    Warning: NonLinear Not Converging in node group" << group-1;
+        }
+        m_warning  = 1;
+        m_nlFailed = true;
+        while( el ){ el->added = false; el = el->nextChanged; }
+        return;
+    }
+    if( m_nlStep[group] == 0 ) m_nlUsed.push_back( group );
+    m_nlStep[group]++;
+    m_nlIters[group]++;
+
+    bool converged = m_converged;
+    m_converged = true;
+    while( el ){
+        el->added = false;
+        if     ( m_profiling ) profileNonLinear( el ); // Profiling: time of each element
+        else if( m_nlBatch && el->nlBatch ) addToBatch( el );
+        else                   el->voltChanged();
+        el = el->nextChanged;
+        m_voltChCount++;
+    }
+    while( m_batchList )  // Evaluate batched elements of this group
+    {
+        m_batchList->queued = false;
+        m_batchList->run();
+        m_batchList = m_batchList->nextBatch;
+    }
+    if( m_converged ) m_nlStep[group] = 0; // This group converged
+    m_converged = converged;
+}
+
+void Simulator::takeNodeSnapshots()
+{
+    m_frontNodes.clear();
+    while( m_animNode )
+    {
+        m_animNode->takeSnapshot();
+        m_frontNodes.append( m_animNode );
+        m_animNode = m_animNode->nextAnim;
+}   }
+
+void Simulator::updateConnectors() // Uses front buffers only
+{
+    QSet<Connector*> connectors;   // Both Pins of a Connector are in the same eNode
+    for( eNode* node : m_frontNodes ) node->getConnectors( connectors );
+    for( Connector* conn : connectors ) conn->updateLines();
+    m_frontNodes.clear();
+}
+
+void Simulator::initNlGroups( int groups )
+{
+    groups += 1;           // Group 0 for single eNodes
+    m_nlList.assign( groups, NULL );
+    m_nlFlag.assign( groups, 0 );
+    m_nlStep.assign( groups, 0 );
+    m_nlIters.assign( groups, 0 );
+    m_nlFails.assign( groups, 0 );
+    m_nlActive.clear();
+    m_nlGroups.clear();
+    m_nlBlocked.clear();
+    m_nlUsed.clear();
+    m_nlFailed = false;
 }
 
 void Simulator::resetSim()
@@ -221,8 +430,15 @@ void Simulator::resetSim()
     m_tStep    = 0;
     m_lastRefT = 0;
     m_circTime = 1;
+    m_simTime  = 1;
     m_updtTime = 0;
-    m_NLstep   = 0;
+    m_eventCount   = 0;
+    m_matrixSolves = 0;
+    m_nlIterations = 0;
+    m_cancelCount  = 0;
+    m_voltChCount  = 0;
+    m_voltSetCount = 0;
+    m_idleSkips    = 0;
     ///m_pauseCirc = false;
     m_simPsPF = 1;
 
@@ -230,7 +446,9 @@ void Simulator::resetSim()
     clearEventList();
     m_changedNode = NULL;
     m_voltChanged = NULL;
-    m_nonLinear = NULL;
+    m_animNode    = NULL;
+    m_frontNodes.clear();
+    initNlGroups( 0 );
 }
 
 void Simulator::createNodes()
@@ -244,12 +462,12 @@ void Simulator::createNodes()
     m_eNodeList.clear();
 
     int i = 0;
-    QStringList pinList;
-    QStringList pinNames = Circuit::self()->m_pinMap.keys();
+    QSet<QString> pinList; // Pins already in an eNode
+    QStringList pinNames = m_circuit->m_pinMap.keys();
     pinNames.sort();
     for( QString pinName : pinNames )
     {
-        Pin* pin = Circuit::self()->m_pinMap.value( pinName );
+        Pin* pin = m_circuit->m_pinMap.value( pinName );
         if( !pin ) continue;
         if( pinList.contains( pinName ) ) continue;
         if( !pin->conPin() ) continue;
@@ -265,7 +483,7 @@ void Simulator::createNodes()
         {
             QString pinId = nodePin->getId();//qDebug() <<pinId<<"\t\t\t"<<nodePin->getEnode()->itemId();
             if( pinId.startsWith("Node") ) continue;
-            if( !pinList.contains(pinId) ) pinList.append( pinId );
+            pinList.insert( pinId );
         }
     }
     /// qDebug() <<"  Created      "<< i << "\teNodes"<<pinList.size()<<"Pins";
@@ -282,7 +500,11 @@ void Simulator::startSim( bool paused )
 
     for( Socket* sock : m_socketList ) sock->updatePins( true );
 
+    QElapsedTimer phaseTimer;  // Time of each start up phase
+    phaseTimer.start();
+
     createNodes();
+    double nodesTime = phaseTimer.nsecsElapsed()/1e6;
 
     /// qDebug() <<"  Initializing "<< m_elementList.size() << "\teElements";
     for( eElement* el : m_elementList )    // Initialize all Elements
@@ -301,9 +523,27 @@ void Simulator::startSim( bool paused )
         enode->initialize();
         //qDebug() << "initializing  "<< enode->itemId();
     }
+    double initTime = phaseTimer.nsecsElapsed()/1e6;
+
     for( eElement* el : m_elementList ) el->stamp();
+    double stampTime = phaseTimer.nsecsElapsed()/1e6;
 
     m_matrix->createMatrix( m_eNodeList );
+    initNlGroups( m_matrix->groups() );
+    double matrixTime = phaseTimer.nsecsElapsed()/1e6;
+
+    if( m_dcOpPoint && !solveOpPoint() ) qDebug() << "    Warning: DC Operating Point not converged";
+    clearProfile();
+    m_stimulus->start();
+    double opTime = phaseTimer.nsecsElapsed()/1e6;
+
+    qDebug() << "    Start up:"<< m_eNodeList.size() << "eNodes," << m_elementList.size() << "eElements"
+             << "\n      createNodes " << nodesTime             << "ms"
+             << "\n      initialize  " << initTime-nodesTime    << "ms"
+             << "\n      stamp       " << stampTime-initTime    << "ms"
+             << "\n      createMatrix" << matrixTime-stampTime  << "ms";
+    if( m_dcOpPoint ) qDebug() << "      DC OP point " << opTime-matrixTime << "ms";
+    qDebug() << "";
 
     /// qDebug() << "\nCircuit Matrix looks good";
 
@@ -333,26 +573,280 @@ void Simulator::startSim( bool paused )
     m_timerId = this->startTimer( m_timerTick_ms, Qt::PreciseTimer ); // Init Timer
 }
 
+bool Simulator::solveOpPoint() // DC operating point with gmin stepping
+{
+    // Reactive elements open or short, nonlinear elements converge in solveCircuit()
+    // with their own step limiting. A conductance to ground in every eNode helps
+    // convergence and is reduced down to 0, reducing it slower if a step fails.
+    for( eElement* el : m_elementList ) el->setOpPoint( true );
+
+    simState_t state = m_state;
+    uint32_t maxNlstp = m_maxNlstp;
+    m_state = SIM_RUNNING;  // solveCircuit() breaks the loop if not running
+    m_maxNlstp = 1000;      // Iterations for each gmin step
+
+    double gmin   = 1e-2;
+    double lastOk = 0;
+    double factor = 10;
+    bool converged = false;
+
+    while( true )
+    {
+        for( eNode* node : m_eNodeList ) node->setGmin( gmin );
+        m_converged = false;
+        m_nlFailed  = false;
+        solveCircuit();
+
+        if( m_converged && !m_nlFailed ){
+            if( gmin == 0 ) { converged = true; break; }
+            lastOk = gmin;
+            gmin /= factor;
+            if( gmin < 1e-12 ) gmin = 0;
+        }else{                                 // Failed: smaller step from last good gmin
+            m_warning = 0;
+            if( factor < 1.1 || lastOk == 0 ) break;
+            factor = sqrt( factor );
+            gmin = lastOk/factor;
+    }   }
+    for( eNode* node : m_eNodeList ) node->setGmin( 0 );
+    for( eElement* el : m_elementList ) el->setOpPoint( false );
+
+    m_nlFailed = false;
+    m_maxNlstp = maxNlstp;
+    m_state = state;
+    return converged;
+}
+
 void Simulator::stopSim()
 {
-    if( m_timerId != 0 ){                   // Stop Timer
+    bool timer = m_timerId != 0;            // Running from GUI
+    if( timer ){                            // Stop Timer
         this->killTimer( m_timerId );
         m_timerId = 0;
     }
     m_state = SIM_STOPPED;
+    releaseCircuit();                       // In case it is waiting for GUI
     if( !m_CircuitFuture.isFinished() ) m_CircuitFuture.waitForFinished();
+    m_stimulus->stop();
+
+    if( timer && InfoWidget::self()->statsVisible() ) InfoWidget::self()->setStats( stats() ); // Final values
 
     qDebug() << "\n    Simulation Stopped ";
+    if( m_profiling ) m_matrix->printStats();
     qDebug() << "\n-------------------------------------------------\n ";
 
     for( eNode* node  : m_eNodeList  )  node->setVolt( 0 );
     for( eElement* el : m_elementList ) el->initialize();
-    for( Updatable* el : m_updateList ) el->updateStep();
-
+    takeNodeSnapshots();
+    updateConnectors();
+    for( Updatable* el : m_updateList )
+    {
+        el->takeSnapshot();
+        el->updateStep();
+    }
     clearEventList();
     m_changedNode = NULL;
 }
 
+bool Simulator::runHeadless( uint64_t simTime, bool maxSpeed, QString loadFile )
+{
+    if( !startHeadless( loadFile ) ) return false;
+    runFor( simTime, maxSpeed );
+    return true;
+}
+
+bool Simulator::startHeadless( QString loadFile )
+{
+    makeCurrent();
+    startSim();
+    if( m_timerId != 0 ){                   // No Timer: loop is run by runFor()
+        this->killTimer( m_timerId );
+        m_timerId = 0;
+    }
+    if( !loadFile.isEmpty() && !loadStateFile( loadFile ) ) return false; // Start from checkpoint
+    return true;
+}
+
+void Simulator::runFor( uint64_t simTime, bool maxSpeed )
+{
+    uint64_t psPF    = m_psPF;
+    uint64_t endTime = m_circTime+simTime;
+    uint64_t startNs = m_RefTimer.nsecsElapsed();
+    uint64_t startPs = m_circTime;
+
+    while( m_state == SIM_RUNNING && !m_error && m_circTime < endTime )
+    {
+        uint64_t left = endTime-m_circTime;
+        if( maxSpeed || left < psPF ) m_psPF = left;  // No frame pacing
+        else                          m_psPF = psPF;
+        runCircuit();
+
+        if( maxSpeed ) continue;
+        uint64_t targetNs = (double)(m_circTime-startPs)*1e9/m_psPerSec; // Keep Simulation speed
+        uint64_t elapsed  = m_RefTimer.nsecsElapsed()-startNs;
+        if( targetNs > elapsed ) QThread::usleep( (targetNs-elapsed)/1000 );
+    }
+    m_psPF = psPF;
+}
+
+// ---- Checkpoints -------------------------------------------
+// Binary format, version 2:
+// magic, version, circTime, eNodes: count + each eNode state,
+// eElements: count + (id, eventTime, eventOrder, state) for each one,
+// ids of eElements with events or callbacks but without checkpoint support (not in version 1).
+// Element state is stored in a byte array, so elements can read only what they wrote.
+
+static const quint32 stateMagic   = 0x53494D53; // "SIMS"
+static const quint16 stateVersion = 2;
+
+QByteArray Simulator::saveState()
+{
+    QByteArray state;
+    if( m_state < SIM_PAUSED ) return state;
+
+    bool hold = !m_CircuitFuture.isFinished();
+    if( hold ) holdCircuit();                // Circuit thread waits in a safe point
+
+    QDataStream out( &state, QIODevice::WriteOnly );
+    out.setVersion( QDataStream::Qt_5_0 );
+    out << stateMagic << stateVersion << (quint64)m_circTime;
+
+    out << (quint32)m_eNodeList.size();
+    for( eNode* node : m_eNodeList ) node->saveState( out );
+
+    QSet<eElement*> callBacks;               // Elements with state not saved in eNodes
+    for( eNode* node : m_eNodeList ) node->getCallBacks( callBacks );
+
+    QStringList noState;
+    out << (quint32)m_elementList.size();
+    for( eElement* el : m_elementList )
+    {
+        QByteArray elState;
+        QDataStream elOut( &elState, QIODevice::WriteOnly );
+        elOut.setVersion( QDataStream::Qt_5_0 );
+        bool saved = el->saveState( elOut );
+        if( !saved && (el->eventTime || callBacks.contains( el )) ) noState.append( el->getId() );
+
+        out << el->getId() << (quint64)el->eventTime << (quint64)el->eventOrder << elState;
+    }
+    out << noState;
+    if( hold ) releaseCircuit();
+
+    if( !noState.isEmpty() )
+        qDebug() << "Warning: Simulator::saveState:" << noState.size() << "elements without checkpoint support:" << noState;
+    return state;
+}
+
+bool Simulator::loadState( const QByteArray& state )
+{
+    if( m_state < SIM_PAUSED ) return false;
+
+    QDataStream in( state );
+    in.setVersion( QDataStream::Qt_5_0 );
+
+    quint32 magic;
+    quint16 version;
+    quint64 circTime;
+    in >> magic >> version >> circTime;
+    if( magic != stateMagic || version < 1 || version > stateVersion )
+    { qDebug() << "Error: Simulator::loadState: Not a valid state, version" << version; return false; }
+
+    quint32 nodes;
+    in >> nodes;
+    if( (int)nodes != m_eNodeList.size() )
+    { qDebug() << "Error: Simulator::loadState: Different circuit"; return false; }
+
+    qint64 nodesPos = in.device()->pos();
+    bool ok = true;     // Check all data before changing anything
+    for( eNode* node : m_eNodeList ) if( !node->checkState( in ) ) { ok = false; break; }
+
+    quint32 elements = 0;
+    if( ok ) in >> elements;
+    if( (int)elements != m_elementList.size() ) ok = false;
+
+    std::vector<quint64> eventTimes;
+    std::vector<quint64> eventOrders;
+    QList<QByteArray> elStates;
+    for( int i=0; ok && i<m_elementList.size(); ++i )
+    {
+        QString id;
+        quint64 eventTime, eventOrder;
+        QByteArray elState;
+        in >> id >> eventTime >> eventOrder >> elState;
+        if( id != m_elementList.at( i )->getId() ) { ok = false; break; }
+
+        eventTimes.push_back( eventTime );
+        eventOrders.push_back( eventOrder );
+        elStates.append( elState );
+    }
+    QStringList noState;
+    if( ok && version > 1 ) in >> noState;
+    if( !ok || in.status() != QDataStream::Ok )
+    { qDebug() << "Error: Simulator::loadState: Different circuit or wrong data"; return false; }
+
+    bool hold = !m_CircuitFuture.isFinished();
+    if( hold ) holdCircuit();
+
+    m_changedNode = NULL;
+    m_voltChanged = NULL;
+    initNlGroups( m_matrix->groups() );
+    clearEventList();
+
+    in.device()->seek( nodesPos );
+    for( eNode* node : m_eNodeList ) node->loadState( in );
+
+    QList<QPair<quint64, eElement*>> events; // Event order, element
+    for( int i=0; i<m_elementList.size(); ++i )
+    {
+        eElement* el = m_elementList.at( i );
+        QDataStream elIn( elStates.at( i ) );
+        elIn.setVersion( QDataStream::Qt_5_0 );
+        el->loadState( elIn );
+        el->added = false;
+        el->eventTime = eventTimes[i];
+        if( el->eventTime ) events.append( qMakePair( eventOrders[i], el ) );
+    }
+    std::sort( events.begin(), events.end() ); // Insert in same order: same order for same time
+    for( QPair<quint64, eElement*> &ev : events ) m_eventQueue.insert( ev.second, ev.second->eventTime );
+
+    m_circTime = circTime;
+    m_simTime.store( m_circTime, std::memory_order_relaxed );
+    m_tStep    = circTime;
+    m_lastStep = circTime;
+
+    if( hold ) releaseCircuit();
+
+    if( !noState.isEmpty() ) // These restart from stamp() state: result differs from uninterrupted run
+        qDebug() << "Warning: Simulator::loadState:" << noState.size() << "elements not restored:" << noState;
+    if( version == 1 ) qDebug() << "Warning: Simulator::loadState: Version 1 state, elements not restored are unknown";
+    return true;
+}
+
+bool Simulator::saveStateFile( QString fileName )
+{
+    QByteArray state = saveState();
+    if( state.isEmpty() ) return false;
+
+    QFile file( fileName );
+    if( !file.open( QFile::WriteOnly ) )
+    { qDebug() << "Error: Simulator::saveStateFile: Cannot write file" << fileName; return false; }
+
+    file.write( state );
+    file.close();
+    return true;
+}
+
+bool Simulator::loadStateFile( QString fileName )
+{
+    QFile file( fileName );
+    if( !file.open( QFile::ReadOnly ) )
+    { qDebug() << "Error: Simulator::loadStateFile: Cannot read file" << fileName; return false; }
+
+    QByteArray state = file.readAll();
+    file.close();
+    return loadState( state );
+}
+
 void Simulator::pauseSim() // Only pause simulation, don't update UI
 {
     if( m_state <= SIM_PAUSED ) return;
@@ -395,6 +889,12 @@ void Simulator::setFps( uint64_t fps )
     setPsPerSec( m_psPerSec );
 }
 
+void Simulator::setAnimFps( uint64_t fps )
+{
+    if( fps < 1 ) fps = 1;
+    m_animFps = fps;
+}
+
 void Simulator::setStepsPerSec( uint64_t sps )
 {
     if( sps < 1 ) sps = 1;
@@ -403,6 +903,33 @@ void Simulator::setStepsPerSec( uint64_t sps )
     setPsPerSec( m_stepsPS*m_stepSize );
 }
 
+void Simulator::setProfiling( bool p )
+{
+    m_profiling = p;
+    m_matrix->setProfiling( p );
+}
+
+void Simulator::resetProfile()
+{
+    if( m_state >= SIM_WAITING ) m_profReset = true; // Simulation thread can be running
+    else                         clearProfile();
+}
+
+void Simulator::clearProfile()
+{
+    m_profReset = false;
+    for( eElement* el : m_elementList ) el->profile = eElement::profile_t();
+    std::fill( m_nlIters.begin(), m_nlIters.end(), 0 );
+    std::fill( m_nlFails.begin(), m_nlFails.end(), 0 );
+    m_matrix->clearProfile();
+}
+
+void Simulator::setMaxSpeed( bool m )
+{
+    m_maxSpeed = m;
+    setPsPerSec( m_psPerSec );
+}
+
 void Simulator::setPsPerSec( uint64_t psPs )
 {
     if( psPs < 1 ) psPs = 1;
@@ -418,12 +945,12 @@ void Simulator::setPsPerSec( uint64_t psPs )
     }
     m_timerTick_ms = 1000/fps;  // in ms
 
-    InfoWidget::self()->setTargetSpeed( 100*m_psPerSec/1e12 );
+    InfoWidget::self()->setTargetSpeed( m_maxSpeed ? -1 : 100*m_psPerSec/1e12 ); // -1: Max speed
 }
 
 void Simulator::clearEventList()
 {
-    m_firstEvent = NULL;
+    m_eventQueue.clear();
 }
 void Simulator::addEvent( uint64_t time, eElement* el )
 {
@@ -432,48 +959,50 @@ void Simulator::addEvent( uint64_t time, eElement* el )
     if( el->eventTime )
     { qDebug() << "Warning: Simulator::addEvent Repeated event"<<el->getId(); return; }
 
-    time += m_circTime;
-    eElement* last  = NULL;
-    eElement* event = m_firstEvent;
-
-    while( event ){
-        if( time <= event->eventTime ) break; // Insert event here
-        last  = event;
-        event = event->nextEvent;
-    }
-    el->eventTime = time;
-
-    if( last ) last->nextEvent = el;
-    else       m_firstEvent = el; // List was empty or insert First
-
-    el->nextEvent = event;
+    m_eventQueue.insert( el, time+m_circTime );
 }
 
 void Simulator::cancelEvents( eElement* el )
 {
     if( el->eventTime == 0 ) return;
-    eElement* event = m_firstEvent;
-    eElement* last  = NULL;
-    eElement* next  = NULL;
     el->eventTime = 0;
+    m_eventQueue.remove( el );
+    m_cancelCount++;
+}
 
-    while( event ){
-        next = event->nextEvent;
-        if( el == event )
-        {
-            if( last ) last->nextEvent = next;
-            else       m_firstEvent = next;
-            event->nextEvent = NULL;
-        }
-        else last = event;
-        event = next;
-}   }
+simStats_t Simulator::stats()
+{
+    simStats_t stats;
+    stats.events       = m_eventCount;
+    stats.cancelled    = m_cancelCount;
+    stats.peakQueue    = m_eventQueue.peak();
+    stats.matrixSolves = m_matrixSolves;
+    stats.nlIterations = m_nlIterations;
+    stats.voltChanged  = m_voltChCount;
+    stats.voltSets     = m_voltSetCount;
+    stats.idleSkips    = m_idleSkips;
+    stats.factorizations = 0;
+    stats.groupSolves    = 0;
+
+    for( int g=0; g<m_matrix->groups(); ++g )
+    {
+        groupStats_t group;
+        group.nodes   = m_matrix->groupSize( g );
+        group.factors = m_matrix->groupFactors( g );
+        group.solves  = m_matrix->groupSolveCount( g );
+        group.nlIters = nlGroupIters( g );
+        stats.factorizations += group.factors;
+        stats.groupSolves    += group.solves;
+        stats.groups.push_back( group );
+    }
+    return stats;
+}
 
-void Simulator::addToEnodeList( eNode* nod )
-{ if( !m_eNodeList.contains(nod) ) m_eNodeList.append( nod ); }
+void Simulator::addToEnodeList( eNode* nod ) // Only called from eNode constructor: never already here
+{ m_eNodeList.append( nod ); }
 
-void Simulator::addToElementList( eElement* el )
-{ if( !m_elementList.contains(el) ) m_elementList.append(el); }
+void Simulator::addToElementList( eElement* el ) // Only called from eElement constructor: never already here
+{ m_elementList.append(el); }
 
 void Simulator::remFromElementList( eElement* el )
 { m_elementList.removeOne(el); }
@@ -482,7 +1011,7 @@ void Simulator::addToUpdateList( Updatable* el )
 { if( !m_updateList.contains(el) ) m_updateList.append(el); }
 
 void Simulator::remFromUpdateList( Updatable* el )
-{ m_updateList.removeOne(el); }
+{ m_updateList.removeOne(el); m_frontList.removeOne(el); }
 
 void Simulator::addToSocketList( Socket* el )
 { if( !m_socketList.contains(el) ) m_socketList.append(el); }
@@ -8,6 +8,8 @@
 
 #include "e-node.h"
 #include "e-element.h"
+#include "nlbatch.h"
+#include "eventqueue.h"
 
 enum simState_t{
     SIM_STOPPED=0,
@@ -19,8 +21,41 @@ enum simState_t{
     SIM_DEBUG,
 };
 
+enum reactInteg_t{     // Integration method for reactive elements
+    REACT_EULER=0,     // Backward Euler
+    REACT_TRAPEZ,      // Trapezoidal
+    REACT_GEAR2,       // Gear 2nd order (BDF2)
+};
+
 #include <QElapsedTimer>
 #include <QFuture>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <vector>
+
+struct groupStats_t      // Statistics of a CircMatrix group
+{
+    int      nodes;
+    uint64_t factors;    // LU factorizations: full, partial or rank update
+    uint64_t solves;     // Forward/back substitutions
+    uint64_t nlIters;    // Non Linear iterations (reset with profiler)
+};
+
+struct simStats_t        // Engine statistics since simulation start
+{
+    uint64_t events;         // Events executed
+    uint64_t cancelled;      // Events cancelled before running
+    uint64_t peakQueue;      // Max pending events
+    uint64_t matrixSolves;   // solveMatrix() calls
+    uint64_t factorizations; // All groups
+    uint64_t groupSolves;    // All groups
+    uint64_t nlIterations;
+    uint64_t voltChanged;    // voltChanged() callbacks, linear and Non Linear
+    uint64_t voltSets;       // eNode::setVolt() calls that changed the voltage
+    uint64_t idleSkips;      // Max speed: jumps to next event in quiescent circuit
+    std::vector<groupStats_t> groups;
+};
 
 class BaseProcessor;
 class Updatable;
@@ -28,6 +63,8 @@ class eElement;
 class Socket;
 class eNode;
 class CircMatrix;
+class Stimulus;
+class Circuit;
 
 class Simulator : public QObject
 {
@@ -38,7 +75,9 @@ class Simulator : public QObject
         Simulator( QObject* parent=0 );
         ~Simulator();
 
- static Simulator* self() { return m_pSelf; }
+ static Simulator* self() { return m_pSelf; } // Current Simulator in this thread
+
+        void makeCurrent();  // Use this Simulator, it's CircMatrix and Circuit in this thread
 
          void addEvent( uint64_t time, eElement* el );
          void cancelEvents( eElement* el );
@@ -48,16 +87,33 @@ class Simulator : public QObject
         void resumeSim();
         void stopSim();
 
+        bool runHeadless( uint64_t simTime, bool maxSpeed, QString loadFile="" ); // Run simTime ps without GUI timer
+        bool startHeadless( QString loadFile="" );       // Start without GUI timer, in GUI thread
+        void runFor( uint64_t simTime, bool maxSpeed );  // Run simTime ps, can be called from any thread
+
+        QByteArray saveState();                  // Checkpoint: binary snapshot of running simulation
+        bool loadState( const QByteArray& state ); // Same circuit must be running
+        bool saveStateFile( QString fileName );
+        bool loadStateFile( QString fileName );
+
+        void holdCircuit();    // GUI thread: stop simulation thread at a safe point to read circuit state
+        void releaseCircuit();
+
         void setWarning( int warning ) { m_warning = warning; }
         
         uint64_t fps() { return m_fps; }
         void setFps( uint64_t fps );
+        uint64_t animFps() { return m_animFps; } // Wire animation refresh rate
+        void setAnimFps( uint64_t fps );
         uint64_t psPerFrame() { return m_psPF; }
         uint64_t simPsPF() { return m_simPsPF; }
 
         uint64_t psPerSec() { return m_psPerSec; } // Speed picosecond/second
         void setPsPerSec( uint64_t psPs );
 
+        bool maxSpeed() { return m_maxSpeed; }   // Run continuously, no speed limit
+        void setMaxSpeed( bool m );
+
         uint64_t stepSize() { return m_stepSize; }
         void setStepSize( uint64_t stepSize ) { m_stepSize = stepSize; }
 
@@ -67,24 +123,72 @@ class Simulator : public QObject
         uint64_t reactStep() { return m_reactStep; }
         void setreactStep( uint64_t rs ) { m_reactStep = rs; }
 
+        int  reactInteg() { return m_reactInteg; }
+        void setReactInteg( int i ) { m_reactInteg = i; }
+
+        bool reactAdapt() { return m_reactAdapt; } // Reactive step from local truncation error
+        void setReactAdapt( bool a ) { m_reactAdapt = a; }
+
+        uint64_t reactStepMin() { return m_reactStepMin; }
+        void setReactStepMin( uint64_t s ) { m_reactStepMin = s; }
+
+        uint64_t reactStepMax() { return m_reactStepMax; }
+        void setReactStepMax( uint64_t s ) { m_reactStepMax = s; }
+
+        double reactTol() { return m_reactTol; }
+        void setReactTol( double t ) { m_reactTol = t; }
+
         void  setSlopeSteps( int steps ) { m_slopeSteps = steps; }
         int slopeSteps( ) { return m_slopeSteps; }
 
         void  setMaxNlSteps( uint32_t steps ) { m_maxNlstp = steps; }
         uint32_t maxNlSteps( ) { return m_maxNlstp; }
+
+        bool dcOpPoint() { return m_dcOpPoint; } // Solve DC operating point before transient
+        void setDcOpPoint( bool op ) { m_dcOpPoint = op; }
+
+        bool nlBatch() { return m_nlBatch; }     // Batch evaluation of Non Linear elements
+        void setNlBatch( bool b ) { m_nlBatch = b; }
+
+        NlBatch* getNlBatch( int type ) { return ( type < (int)m_nlBatches.size() ) ? m_nlBatches[type] : NULL; }
+        void addNlBatch( int type, NlBatch* batch );
         
         bool isRunning() { return (m_state >= SIM_STARTING); }
         bool isPaused()  { return (m_state == SIM_PAUSED); }
         bool isPauseDebug() { return (m_state == SIM_PAUSED && m_debug == true); }
 
         uint64_t circTime() { return m_circTime; }
+        uint64_t simTime() { return m_simTime.load( std::memory_order_relaxed ); } // Safe from any thread
 
         void timerEvent( QTimerEvent* e );
 
         double realSpeed() { return m_realSpeed; } // 0 to 10000 => 0 to 100%
 
+        uint64_t eventCount()   { return m_eventCount; }
+        uint64_t matrixSolves() { return m_matrixSolves; }
+        uint64_t nlIterations() { return m_nlIterations; }
+
+        simStats_t stats(); // Read only when simulation thread is stopped or parked
+
+        int error()   { return m_error; }
+        int warning() { return m_warning; }
+        QString errorText()   { return m_errors.value( m_error ); }
+        QString warningText() { return m_warnings.value( m_warning ); }
+
         simState_t simState() { return m_state; }
 
+        bool profiling() { return m_profiling; }   // Time used by each eElement and node group
+        void setProfiling( bool p );
+        void resetProfile();
+        const QList<eElement*>& elementList() { return m_elementList; }
+
+        CircMatrix* matrix() { return m_matrix; }
+        eNode::Arenas* nodeArenas() { return m_nodeArenas; }
+        Circuit* circuit() { return m_circuit; }
+
+        uint64_t nlGroupIters( int g ) { return (g+1 < (int)m_nlIters.size()) ? m_nlIters[g+1] : 0; } // Non Linear diagnostics
+        uint64_t nlGroupFails( int g ) { return (g+1 < (int)m_nlFails.size()) ? m_nlFails[g+1] : 0; } // by CircMatrix group
+
         inline void notCorverged() { m_converged = false; }
 
         void addToEnodeList( eNode* nod );
@@ -99,29 +203,86 @@ class Simulator : public QObject
         void remFromSocketList( Socket* el );
 
     private:
- static Simulator* m_pSelf;
+ static thread_local Simulator* m_pSelf;
 
         // Accelerate calls from eNode:
         inline void addToChangedNodes( eNode* nod ) { nod->nextCH = m_changedNode; m_changedNode = nod; }
+        inline void addToAnimNodes( eNode* nod ) { nod->nextAnim = m_animNode; m_animNode = nod; }
         inline void addToChangedList( eElement* el ) { el->nextChanged = m_voltChanged; m_voltChanged = el; }
-        inline void addToNoLinList( eElement* el ) { el->nextChanged = m_nonLinear;  m_nonLinear = el; }
+        inline void addToNoLinList( eElement* el, int group ) // group: CircMatrix group+1, 0 for single eNodes
+        {
+            el->nextChanged = m_nlList[group];
+            m_nlList[group] = el;
+            if( m_nlFlag[group] ) return;
+            m_nlFlag[group] = 1;
+            m_nlActive.push_back( group );
+        }
 
         void createNodes();
         void resetSim();
         void runCircuit();
+        void runContinuous();
         inline void solveCircuit();
+        inline void solveNonLinear( int group );
+        inline void addToBatch( eElement* el )
+        {
+            NlBatch* batch = el->nlBatch;
+            batch->add( el );
+            if( batch->queued ) return;
+            batch->queued = true;
+            batch->nextBatch = m_batchList;
+            m_batchList = batch;
+        }
+        void initNlGroups( int groups );
+
+        void guiSync();
         inline void solveMatrix();
 
+        inline bool idle() // No changes pending to solve
+        { return !m_changedNode && m_nlActive.empty() && m_converged && !m_voltChanged; }
+
+        void takeNodeSnapshots(); // Simulation stopped: front buffer of changed eNodes only
+        void updateConnectors();  // Repaint wires of eNodes in last snapshot
+
         inline void clearEventList();
 
+        void clearProfile();
+
+        bool solveOpPoint();
+
+        inline void profileEvent( eElement* el )
+        {
+            uint64_t time = m_RefTimer.nsecsElapsed();
+            el->runEvent();
+            el->profile.eventTime += m_RefTimer.nsecsElapsed()-time;
+            el->profile.events++;
+        }
+        inline void profileVoltChanged( eElement* el )
+        {
+            uint64_t time = m_RefTimer.nsecsElapsed();
+            el->voltChanged();
+            el->profile.voltTime += m_RefTimer.nsecsElapsed()-time;
+            el->profile.voltChanges++;
+        }
+        inline void profileNonLinear( eElement* el )
+        {
+            uint64_t time = m_RefTimer.nsecsElapsed();
+            el->voltChanged();
+            el->profile.nlTime += m_RefTimer.nsecsElapsed()-time;
+            el->profile.nlIters++;
+        }
+
         //inline void stopTimer();
         //inline void initTimer();
 
-        eElement* m_firstEvent;
+        EventQueue m_eventQueue;
 
         QFuture<void> m_CircuitFuture;
 
         CircMatrix* m_matrix;
+        eNode::Arenas* m_nodeArenas; // Freed when this and all its eNodes are deleted
+        Stimulus*   m_stimulus;
+        Circuit*    m_circuit;
 
         QHash<int, QString> m_errors;
         QHash<int, QString> m_warnings;
@@ -130,10 +291,27 @@ class Simulator : public QObject
 
         eNode*    m_changedNode;
         eElement* m_voltChanged;
-        eElement* m_nonLinear;
+        eNode*    m_animNode;    // Volt changed since last animation frame
+
+        QList<eNode*> m_frontNodes; // eNodes to animate in this frame
+
+        std::vector<eElement*> m_nlList;   // Non Linear elements to solve in each node group
+        std::vector<char>      m_nlFlag;   // Group is in m_nlActive
+        std::vector<int>       m_nlActive; // Groups with Non Linear elements to solve
+        std::vector<int>       m_nlGroups;
+        std::vector<int>       m_nlBlocked; // Groups that reached max iterations in this solveCircuit()
+        std::vector<int>       m_nlUsed;    // Groups iterated since Non Linear loop started
+        std::vector<uint32_t>  m_nlStep;    // Iterations without converging
+        std::vector<uint64_t>  m_nlIters;   // Statistics by group
+        std::vector<uint64_t>  m_nlFails;
+        bool m_nlFailed;
+        bool m_nlBatch;
+        NlBatch* m_batchList;  // Batches with elements added in this group pass
+        std::vector<NlBatch*> m_nlBatches; // Batch of each type, owned by this Simulator
 
         QList<eElement*> m_elementList;
         QList<Updatable*> m_updateList;
+        QList<Updatable*> m_frontList; // Updatables with front buffer: updated in parallel with simulation
         QList<Socket*> m_socketList;
 
         simState_t m_state;
@@ -142,19 +320,28 @@ class Simulator : public QObject
         bool m_debug;
         bool m_converged;
         bool m_pauseCirc;
+        bool m_maxSpeed;
+        bool m_dcOpPoint;
+        bool m_profiling;
+        bool m_profReset;  // Reset profile when simulation thread is stopped
 
         int m_error;
         int m_warning;
         int m_timerId;
         int m_timerTick_ms;
         int m_slopeSteps;
+        int m_reactInteg;
+        bool m_reactAdapt;
+        double m_reactTol;
 
         double m_realFPS;
         uint64_t m_fps;
-        uint32_t m_NLstep;
+        uint64_t m_animFps;
         uint32_t m_maxNlstp;
 
         uint64_t m_reactStep;
+        uint64_t m_reactStepMin;
+        uint64_t m_reactStepMax;
         uint64_t m_psPerSec;
         uint64_t m_stepSize;  ///
         uint64_t m_stepsPS;   ///
@@ -164,6 +351,7 @@ class Simulator : public QObject
 
         uint64_t m_timerTime;
         uint64_t m_circTime;
+        std::atomic<uint64_t> m_simTime; // m_circTime published by simulation thread
         uint64_t m_tStep;
         uint64_t m_lastStep;
         uint64_t m_refTime;
@@ -173,7 +361,21 @@ class Simulator : public QObject
         uint64_t m_updtTime;
         double   m_simLoad;
 
+        uint64_t m_eventCount;   // Statistics since simulation start
+        uint64_t m_matrixSolves;
+        uint64_t m_nlIterations;
+        uint64_t m_cancelCount;
+        uint64_t m_voltChCount;
+        uint64_t m_voltSetCount;
+        uint64_t m_idleSkips;    // Frames jumped in fast-forward
+
         QElapsedTimer m_RefTimer;
+
+        std::atomic<bool> m_guiRequest; // Max speed: GUI wants simulation thread stopped
+        bool m_simParked;               // Simulation thread is stopped at a safe point
+        bool m_fastForward;             // Max speed: quiescent circuit jumps to next event
+        QMutex m_syncMutex;
+        QWaitCondition m_syncCond;
 };
  #endif
 
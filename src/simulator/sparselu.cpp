@@ -0,0 +1,205 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <QDebug>
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+#include "sparselu.h"
+
+SparseLU::SparseLU()
+{
+    m_n = 0;
+    m_firstChange = 0;
+    m_missVal = 0;
+    m_fullFactors    = 0;
+    m_partialFactors = 0;
+}
+SparseLU::~SparseLU(){}
+
+void SparseLU::analyze( int n, const std::vector<i_vector_t> &pattern )
+{
+    m_n = n;
+
+    std::vector<i_vector_t> adj( n );         // Symmetric pattern without diagonal
+    for( int r=0; r<n; ++r )
+    {
+        for( int c : pattern[r] )
+        {
+            if( c == r ) continue;
+            adj[r].push_back( c );
+            adj[c].push_back( r );
+    }   }
+    for( i_vector_t &nbrs : adj )
+    {
+        std::sort( nbrs.begin(), nbrs.end() );
+        nbrs.erase( std::unique( nbrs.begin(), nbrs.end() ), nbrs.end() );
+    }
+
+    m_aRowPtr.assign( n+1, 0 );               // Stamped values: symmetric pattern + diagonal
+    m_aCol.clear();
+    for( int r=0; r<n; ++r )
+    {
+        bool diag = false;
+        for( int c : adj[r] )
+        {
+            if( !diag && c > r ) { m_aCol.push_back( r ); diag = true; }
+            m_aCol.push_back( c );
+        }
+        if( !diag ) m_aCol.push_back( r );
+        m_aRowPtr[r+1] = m_aCol.size();
+    }
+    m_aVal.assign( m_aCol.size(), 0 );
+
+    std::vector<i_vector_t> elimNbrs;         // Ordering and symbolic factorization
+    minDegreeOrder( adj, elimNbrs );
+
+    std::vector<i_vector_t> luRows( n );
+    for( int k=0; k<n; ++k )
+    {
+        luRows[k].push_back( k );             // Diagonal
+        for( int u : elimNbrs[k] )
+        {
+            int i = m_iperm[u];
+            luRows[k].push_back( i );         // U(k,i)
+            luRows[i].push_back( k );         // L(i,k)
+    }   }
+    m_luRowPtr.assign( n+1, 0 );
+    m_luDiag.assign( n, 0 );
+    m_luCol.clear();
+    for( int i=0; i<n; ++i )
+    {
+        i_vector_t &row = luRows[i];
+        std::sort( row.begin(), row.end() );
+        for( int c : row )
+        {
+            if( c == i ) m_luDiag[i] = m_luCol.size();
+            m_luCol.push_back( c );
+        }
+        m_luRowPtr[i+1] = m_luCol.size();
+    }
+    m_luVal.assign( m_luCol.size(), 0 );
+
+    m_aToLu.resize( m_aCol.size() );
+    for( int r=0; r<n; ++r )
+    {
+        for( int p=m_aRowPtr[r]; p<m_aRowPtr[r+1]; ++p )
+            m_aToLu[p] = find( m_luRowPtr, m_luCol, m_iperm[r], m_iperm[ m_aCol[p] ] );
+    }
+    m_work.assign( n, 0 );
+    m_firstChange = 0;                         // First factor() does all rows
+}
+
+void SparseLU::minDegreeOrder( const std::vector<i_vector_t> &adj, std::vector<i_vector_t> &elimNbrs )
+{
+    // Eliminate the node with less neighbours first; neighbours of eliminated node
+    // become a clique (fill-in). Neighbours at elimination time are the L/U pattern.
+    int n = m_n;
+    std::vector<i_vector_t> graph = adj;
+    i_vector_t merged;
+
+    m_perm.resize( n );
+    m_iperm.resize( n );
+    elimNbrs.assign( n, i_vector_t() );
+
+    std::set<std::pair<int,int>> degrees;    // (degree, node): first is next to eliminate, lowest node for same degree
+    for( int i=0; i<n; ++i ) degrees.insert( { (int)graph[i].size(), i } );
+
+    for( int k=0; k<n; ++k )
+    {
+        int v = degrees.begin()->second;
+        degrees.erase( degrees.begin() );
+        m_perm[k]  = v;
+        m_iperm[v] = k;
+
+        i_vector_t &nbrs = graph[v];
+        for( int u : nbrs )
+        {
+            i_vector_t &uNbrs = graph[u];
+            degrees.erase( { (int)uNbrs.size(), u } );
+            merged.clear();
+            std::set_union( uNbrs.begin(), uNbrs.end(), nbrs.begin(), nbrs.end(), std::back_inserter( merged ) );
+            uNbrs.clear();
+            for( int w : merged ) if( w != u && w != v ) uNbrs.push_back( w );
+            degrees.insert( { (int)uNbrs.size(), u } );
+        }
+        elimNbrs[k].swap( nbrs );
+    }
+}
+
+double* SparseLU::missedEntry( int row, int col )
+{
+    qDebug() << "Error: SparseLU::entry: Not in pattern:" << row << col;
+    Q_ASSERT( false );
+    return &m_missVal;
+}
+
+void SparseLU::factor() // Row by row Doolittle over the fixed pattern
+{
+    int first = m_firstChange;
+    if( first >= m_n ) return;                // Nothing changed
+    m_firstChange = m_n;
+
+    if( first == 0 ) m_fullFactors++;
+    else             m_partialFactors++;
+
+    int firstPos = m_luRowPtr[first];         // Rows before first keep their values
+    std::fill( m_luVal.begin()+firstPos, m_luVal.end(), 0 );
+    for( unsigned p=0; p<m_aVal.size(); ++p )
+        if( m_aToLu[p] >= firstPos ) m_luVal[ m_aToLu[p] ] = m_aVal[p];
+
+    double* w = m_work.data();
+
+    for( int i=first; i<m_n; ++i )
+    {
+        int start = m_luRowPtr[i];
+        int end   = m_luRowPtr[i+1];
+        int diag  = m_luDiag[i];
+
+        for( int p=start; p<end; ++p ) w[ m_luCol[p] ] = m_luVal[p];
+
+        for( int p=start; p<diag; ++p )       // Lower triangular elements
+        {
+            int k = m_luCol[p];
+            double div = m_luVal[ m_luDiag[k] ];
+            double l = w[k];
+            if( div != 0 ) l /= div;
+            w[k] = l;
+            if( l == 0 ) continue;
+
+            for( int q=m_luDiag[k]+1; q<m_luRowPtr[k+1]; ++q ) w[ m_luCol[q] ] -= l*m_luVal[q];
+        }
+        for( int p=start; p<end; ++p ) m_luVal[p] = w[ m_luCol[p] ];
+    }
+}
+
+bool SparseLU::solve( const d_vector_t &b, d_vector_t &x )
+{
+    double* y = m_work.data();
+
+    for( int i=0; i<m_n; ++i )                // Forward substitution from lower triangular matrix
+    {
+        double tot = b[ m_perm[i] ];
+        for( int p=m_luRowPtr[i]; p<m_luDiag[i]; ++p ) tot -= m_luVal[p]*y[ m_luCol[p] ];
+        y[i] = tot;
+    }
+    bool isOk = true;
+
+    for( int i=m_n-1; i>=0; --i )             // Back substitution from upper triangular matrix
+    {
+        double tot = y[i];
+        for( int p=m_luDiag[i]+1; p<m_luRowPtr[i+1]; ++p ) tot -= m_luVal[p]*y[ m_luCol[p] ];
+
+        double div = m_luVal[ m_luDiag[i] ];
+        double volt = 0;
+        if( div != 0 ) volt = tot/div;
+        else isOk = false;
+
+        y[i] = volt;
+        x[ m_perm[i] ] = volt;
+    }
+    return isOk;
+}
@@ -0,0 +1,96 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef SPARSELU_H
+#define SPARSELU_H
+
+#include <vector>
+#include <cstdint>
+
+// Sparse LU factorization for big node groups.
+// analyze() runs once per simulation start: gets a minimum degree ordering
+// and the fill pattern of L/U. factor() only does numeric refactorization.
+// No pivoting, same as the dense Crout path in CircMatrix.
+// Rows before the first changed one (in elimination order) keep their factors,
+// factor() only recomputes from there.
+
+class SparseLU
+{
+    typedef std::vector<int>    i_vector_t;
+    typedef std::vector<double> d_vector_t;
+
+    public:
+        SparseLU();
+        ~SparseLU();
+
+        // pattern[row] = columns with non zero values (local indexes), diagonal is added.
+        void analyze( int n, const std::vector<i_vector_t> &pattern );
+
+        inline double* entry( int row, int col )
+        {
+            int p = find( m_aRowPtr, m_aCol, row, col );
+            if( m_aCol[p] != col ) return missedEntry( row, col ); // Not in analyzed pattern
+            return &m_aVal[p];
+        }
+        inline double* diagonal( int row ) { return entry( row, row ); }
+
+        inline void changed( int row, int col ) // Stamped value at row,col changed
+        {
+            int k = m_iperm[row];
+            if( m_iperm[col] < k ) k = m_iperm[col];
+            if( k < m_firstChange ) m_firstChange = k;
+        }
+
+        void factor();
+        bool solve( const d_vector_t &b, d_vector_t &x ); // b, x in original order
+
+        int size() { return m_n; }
+        int nonZeros() { return m_luCol.size(); } // Including fill-in
+
+        uint64_t fullFactors()    { return m_fullFactors; }
+        uint64_t partialFactors() { return m_partialFactors; }
+
+    private:
+        double* missedEntry( int row, int col );
+
+        void minDegreeOrder( const std::vector<i_vector_t> &adj, std::vector<i_vector_t> &elimNbrs );
+
+        inline int find( const i_vector_t &rowPtr, const i_vector_t &cols, int row, int col )
+        {
+            int lo = rowPtr[row];
+            int hi = rowPtr[row+1]-1;
+            while( lo < hi )
+            {
+                int mid = (lo+hi)/2;
+                if( cols[mid] < col ) lo = mid+1;
+                else                  hi = mid;
+            }
+            return lo;
+        }
+
+        int m_n;
+        int m_firstChange;    // First row (elimination order) changed since last factor()
+
+        i_vector_t m_perm;   // m_perm[k]  = original row at position k
+        i_vector_t m_iperm;  // m_iperm[r] = position of original row r
+
+        i_vector_t m_aRowPtr; // Stamped values (original order)
+        i_vector_t m_aCol;
+        d_vector_t m_aVal;
+        i_vector_t m_aToLu;   // Position of each stamped value in LU
+
+        i_vector_t m_luRowPtr; // L (unit diagonal) and U (permuted order)
+        i_vector_t m_luCol;
+        i_vector_t m_luDiag;
+        d_vector_t m_luVal;
+
+        d_vector_t m_work;
+        double     m_missVal; // Values stamped out of pattern go here
+
+        uint64_t m_fullFactors;
+        uint64_t m_partialFactors;
+};
+
+#endif
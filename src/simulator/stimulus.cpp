@@ -0,0 +1,212 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+
+#include "stimulus.h"
+#include "simulator.h"
+#include "circuit.h"
+#include "mainwindow.h"
+
+// Log file format, version 2:
+// magic, version, sources: count + eElement ids,
+// inputs: count + (time, sequence, source index, data) for each one, sorted by time.
+// Version 1 has no sequence: file order is used.
+
+static const quint32 stimMagic   = 0x53494D49; // "SIMI"
+static const quint16 stimVersion = 2;
+
+thread_local Stimulus* Stimulus::m_pSelf = NULL;
+
+Stimulus::Stimulus()
+        : eElement( "Stimulus" )
+{
+    m_pSelf = this;
+
+    m_record    = MainWindow::self()->settings()->value( "recordInputs", false ).toBool();
+    m_recording = false;
+    m_replaying = false;
+    m_index = 0;
+}
+Stimulus::~Stimulus()
+{
+    if( m_pSelf == this ) m_pSelf = NULL;
+}
+
+void Stimulus::start()
+{
+    m_recording = false;
+    m_replaying = false;
+    m_inputs.clear();
+    m_sources.clear();
+    m_sourceIndex.clear();
+    m_sourceElements.clear();
+    m_index = 0;
+
+    if( !m_replayFile.isEmpty() )
+    {
+        if( !readLog( m_replayFile ) ) return;
+        m_replaying = true;
+        scheduleNext();
+        qDebug() << "    Replaying" << m_inputs.size() << "inputs from" << m_replayFile;
+    }
+    else if( m_record )
+    {
+        QString circFile = m_sim->circuit()->getFilePath();
+        if( circFile.isEmpty() )
+        { qDebug() << "Warning: Stimulus::start: Circuit not saved, inputs not recorded"; return; }
+
+        QFileInfo fi( circFile );
+        m_recordFile = fi.absolutePath()+"/"+fi.completeBaseName()+".stim";
+        m_recording = true;
+    }
+}
+
+void Stimulus::stop()
+{
+    if( m_recording )
+    {
+        m_recording = false;
+        if( writeLog( m_recordFile ) )
+            qDebug() << "    Recorded" << m_inputs.size() << "inputs to" << m_recordFile;
+    }
+    m_replaying = false;
+}
+
+void Stimulus::addInput( eElement* el, const QByteArray& data )
+{
+    if( !m_recording ) return;
+
+    QString id = el->getId();
+    int source = m_sourceIndex.value( id, -1 );
+    if( source < 0 )
+    {
+        source = m_sources.size();
+        m_sources.append( id );
+        m_sourceIndex[id] = source;
+    }
+    m_inputs.push_back( { m_sim->circTime(), (uint32_t)m_inputs.size(), source, data } );
+}
+
+void Stimulus::runEvent()
+{
+    uint64_t time = m_sim->circTime();
+
+    while( m_index < m_inputs.size() ) // All inputs at this time
+    {
+        const input_t& input = m_inputs[m_index];
+        if( input.time > time ) break;
+
+        eElement* el = m_sourceElements[input.source];
+        if( el ) el->replayInput( input.data );
+        m_index++;
+    }
+    scheduleNext();
+}
+
+void Stimulus::scheduleNext()
+{
+    if( m_index >= m_inputs.size() ) return;
+
+    uint64_t time = m_sim->circTime();
+    uint64_t next = m_inputs[m_index].time;
+    m_sim->addEvent( (next > time) ? next-time : 0, this );
+}
+
+bool Stimulus::saveState( QDataStream& out )
+{
+    out << (quint32)m_index;
+    return true;
+}
+
+void Stimulus::loadState( QDataStream& in )
+{
+    quint32 index;
+    in >> index;
+    if( m_replaying && index <= m_inputs.size() ) m_index = index;
+}
+
+bool Stimulus::writeLog( QString fileName )
+{
+    QFile file( fileName );
+    if( !file.open( QFile::WriteOnly ) )
+    { qDebug() << "Error: Stimulus::writeLog: Cannot write file" << fileName; return false; }
+
+    QDataStream out( &file );
+    out.setVersion( QDataStream::Qt_5_0 );
+    out << stimMagic << stimVersion;
+
+    out << (quint32)m_sources.size();
+    for( const QString& id : m_sources ) out << id;
+
+    out << (quint32)m_inputs.size();
+    for( const input_t& input : m_inputs )
+        out << (quint64)input.time << (quint32)input.seq << (quint16)input.source << input.data;
+
+    file.close();
+    return true;
+}
+
+bool Stimulus::readLog( QString fileName )
+{
+    QFile file( fileName );
+    if( !file.open( QFile::ReadOnly ) )
+    { qDebug() << "Error: Stimulus::readLog: Cannot read file" << fileName; return false; }
+
+    QDataStream in( &file );
+    in.setVersion( QDataStream::Qt_5_0 );
+
+    quint32 magic;
+    quint16 version;
+    in >> magic >> version;
+    if( magic != stimMagic || version < 1 || version > stimVersion )
+    { qDebug() << "Error: Stimulus::readLog: Wrong file format" << fileName; return false; }
+
+    QHash<QString, eElement*> elements;
+    for( eElement* el : m_sim->elementList() )
+        if( !elements.contains( el->getId() ) ) elements[el->getId()] = el;
+
+    quint32 sources;
+    in >> sources;
+    for( quint32 i=0; i<sources; ++i )
+    {
+        QString id;
+        in >> id;
+        eElement* el = elements.value( id, NULL );
+        if( !el ) qDebug() << "Warning: Stimulus::readLog: Element not found:" << id;
+        m_sources.append( id );
+        m_sourceElements.push_back( el );
+    }
+    quint32 inputs;
+    in >> inputs;
+    for( quint32 i=0; i<inputs; ++i )
+    {
+        quint64 time;
+        quint32 seq = i;
+        quint16 source;
+        QByteArray data;
+        in >> time;
+        if( version > 1 ) in >> seq;
+        in >> source >> data;
+        if( source >= sources ) { in.setStatus( QDataStream::ReadCorruptData ); break; }
+        m_inputs.push_back( { time, seq, source, data } );
+    }
+    file.close();
+
+    std::sort( m_inputs.begin(), m_inputs.end(), []( const input_t& a, const input_t& b )
+               { return (a.time != b.time) ? a.time < b.time : a.seq < b.seq; } );
+
+    if( in.status() != QDataStream::Ok )
+    {
+        qDebug() << "Error: Stimulus::readLog: Corrupt file" << fileName;
+        m_inputs.clear();
+        return false;
+    }
+    return true;
+}
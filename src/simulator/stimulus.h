@@ -0,0 +1,83 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef STIMULUS_H
+#define STIMULUS_H
+
+#include <vector>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+
+#include "e-element.h"
+
+// Record and replay of inputs coming from outside the simulation:
+// buttons, switches, dials, serial port data...
+// Components call addInput() at the point the input takes effect in the circuit,
+// it is stored with the current circTime and written to a log file when simulation stops.
+// In replay mode inputs are read from a log file and given back to the same
+// eElements at the same simulation times with replayInput(), live inputs are ignored.
+
+class Stimulus : public eElement
+{
+    public:
+        Stimulus();
+        ~Stimulus();
+
+ static Stimulus* self() { return m_pSelf; } // Stimulus of current Simulator in this thread
+
+        void makeCurrent() { m_pSelf = this; }
+
+        virtual void runEvent() override;
+
+        virtual bool saveState( QDataStream& out ) override;
+        virtual void loadState( QDataStream& in ) override;
+
+        void start();  // Called by Simulator at start up
+        void stop();   // Called by Simulator when stopped: write log if recording
+
+        bool record() { return m_record; }
+        void setRecord( bool r ) { m_record = r; }
+
+        QString replayFile() { return m_replayFile; }
+        void setReplayFile( QString f ) { m_replayFile = f; }
+
+        bool recording() { return m_recording; }
+        bool replaying() { return m_replaying; }
+
+        void addInput( eElement* el, const QByteArray& data );
+
+        bool writeLog( QString fileName );
+        bool readLog( QString fileName );
+
+    private:
+ static thread_local Stimulus* m_pSelf;
+
+        struct input_t
+        {
+            uint64_t   time;
+            uint32_t   seq;     // Recording order: same time inputs replay in this order
+            int        source;  // Index in m_sources
+            QByteArray data;
+        };
+
+        void scheduleNext();
+
+        bool m_record;
+        bool m_recording;
+        bool m_replaying;
+
+        QString m_recordFile;
+        QString m_replayFile;
+
+        std::vector<input_t> m_inputs;
+        uint32_t m_index;                    // Next input to replay
+
+        QStringList m_sources;               // eElement ids
+        QHash<QString, int> m_sourceIndex;
+        std::vector<eElement*> m_sourceElements;
+};
+
+#endif
@@ -0,0 +1,310 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#include <qtconcurrentrun.h>
+#include <QDomDocument>
+#include <QTextStream>
+#include <QFile>
+#include <QDebug>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "sweep.h"
+#include "headless.h"
+#include "circuit.h"
+#include "simulator.h"
+#include "stimulus.h"
+#include "utils.h"
+
+Sweep::Sweep()
+{
+    m_simTime = 1e12;
+    m_runs = 1;
+    m_seed = 1;
+}
+Sweep::~Sweep(){}
+
+bool Sweep::loadSpec( QString fileName )
+{
+    QDomDocument domDoc = fileToDomDoc( fileName, "Sweep::loadSpec" );
+    QDomElement root = domDoc.documentElement();
+    if( root.tagName() != "sweep" )
+    { qDebug() << "Error: Sweep::loadSpec: Not a sweep file:" << fileName; return false; }
+
+    bool ok = true;
+    if( root.hasAttribute("time") ) m_simTime = timeToPs( root.attribute("time"), &ok );
+    if( !ok || m_simTime == 0 )
+    { qDebug() << "Error: Sweep::loadSpec: Wrong time:" << root.attribute("time"); return false; }
+
+    m_runs = root.attribute("runs", "1").toInt();
+    m_seed = root.attribute("seed", "1").toUInt();
+    if( m_runs < 1 ) m_runs = 1;
+
+    QHash<QString, CompBase*>* compMap = Circuit::self()->compMap();
+
+    QDomNode node = root.firstChild();
+    for( ; !node.isNull(); node = node.nextSibling() )
+    {
+        QDomElement element = node.toElement();
+        if( element.tagName() == "param" )
+        {
+            param_t param;
+            param.comp = element.attribute("comp");
+            param.prop = element.attribute("prop");
+            param.nominal = 0;
+            param.tolerance = 0;
+            param.gauss = element.attribute("dist") == "gauss";
+
+            CompBase* comp = compMap->value( param.comp );
+            if( !comp )
+            { qDebug() << "Error: Sweep::loadSpec: Component not found:" << param.comp; return false; }
+
+            if( !comp->hasProp( param.prop ) )
+            { qDebug() << "Error: Sweep::loadSpec: Property not found:" << param.comp << param.prop; return false; }
+
+            QString current = comp->getPropStr( param.prop ); // "number unit"
+
+            QStringList curList = current.split(" ");
+            param.unit = element.attribute("unit", curList.size() > 1 ? curList.last() : "" );
+
+            if( element.hasAttribute("values") )
+            {
+                param.values = element.attribute("values").split(";");
+            }
+            else if( element.hasAttribute("from") )
+            {
+                double from = element.attribute("from").toDouble();
+                double to   = element.attribute("to").toDouble();
+                int steps   = element.attribute("steps", "2").toInt();
+                bool logScale = element.attribute("log").toInt();
+                if( steps < 1 ) steps = 1;
+                if( logScale && ( from <= 0 || to <= 0 ) )
+                { qDebug() << "Error: Sweep::loadSpec: Log range must be > 0:" << param.comp << param.prop; return false; }
+
+                for( int i=0; i<steps; ++i )
+                {
+                    double x = (steps > 1) ? (double)i/(steps-1) : 0;
+                    double val = logScale ? from*pow( to/from, x ) : from+(to-from)*x;
+                    param.values.append( QString::number( val, 'g', 10 )+" "+param.unit );
+                }
+            }
+            else if( element.hasAttribute("tolerance") )
+            {
+                param.nominal   = element.attribute("nominal", curList.first() ).toDouble();
+                param.tolerance = element.attribute("tolerance").toDouble()/100;
+            }
+            else
+            { qDebug() << "Error: Sweep::loadSpec: No values for:" << param.comp << param.prop; return false; }
+
+            m_params.push_back( param );
+        }
+        else if( element.tagName() == "observe" )
+        {
+            observe_t observ;
+            observ.name = element.attribute("name");
+            if( element.hasAttribute("probe") ) observ.pin = element.attribute("probe")+"-inpin";
+            else                                observ.pin = element.attribute("pin");
+            if( observ.name.isEmpty() ) observ.name = observ.pin;
+
+            if( !Circuit::self()->getPin( observ.pin ) )
+            { qDebug() << "Error: Sweep::loadSpec: Pin not found:" << observ.pin; return false; }
+
+            if( element.hasAttribute("step") )  // Waveform
+            {
+                uint64_t step = timeToPs( element.attribute("step"), &ok );
+                if( !ok || step == 0 )
+                { qDebug() << "Error: Sweep::loadSpec: Wrong step:" << element.attribute("step"); return false; }
+
+                for( uint64_t time=step; time<=m_simTime; time+=step ) observ.times.push_back( time );
+            }else{
+                uint64_t time = m_simTime;
+                if( element.hasAttribute("time") ) time = timeToPs( element.attribute("time"), &ok );
+                if( !ok || time > m_simTime )
+                { qDebug() << "Error: Sweep::loadSpec: Wrong time:" << element.attribute("time"); return false; }
+
+                observ.times.push_back( time );
+            }
+            m_times.insert( m_times.end(), observ.times.begin(), observ.times.end() );
+            m_observs.push_back( observ );
+    }   }
+    m_times.push_back( m_simTime ); // Always run upto the end
+    std::sort( m_times.begin(), m_times.end() );
+    m_times.erase( std::unique( m_times.begin(), m_times.end() ), m_times.end() );
+
+    createVariants();
+    return true;
+}
+
+void Sweep::createVariants() // Every combination of value lists, m_runs times each
+{
+    std::mt19937 random( m_seed );
+
+    int combinations = 1;
+    for( param_t& param : m_params ) if( !param.values.isEmpty() ) combinations *= param.values.size();
+
+    for( int c=0; c<combinations; ++c )
+    {
+        for( int r=0; r<m_runs; ++r )
+        {
+            QStringList variant;
+            int index = c;
+            for( param_t& param : m_params )
+            {
+                if( !param.values.isEmpty() )
+                {
+                    variant.append( param.values.at( index % param.values.size() ) );
+                    index /= param.values.size();
+                    continue;
+                }
+                double val = param.nominal;
+                double tol = fabs( param.nominal )*param.tolerance;
+                if( tol > 0 )
+                {
+                    if( param.gauss ) val = std::normal_distribution<double>( val, tol/3 )( random );
+                    else              val = std::uniform_real_distribution<double>( val-tol, val+tol )( random );
+                }
+                variant.append( QString::number( val, 'g', 10 )+" "+param.unit );
+            }
+            m_variants.push_back( variant );
+    }   }
+    int columns = 0;
+    for( observe_t& observ : m_observs ) columns += observ.times.size();
+
+    m_results.assign( m_variants.size(), std::vector<double>( columns, NAN ) );
+    m_status.assign( m_variants.size(), "" );
+}
+
+bool Sweep::run( QString circFile, int jobs )
+{
+    Simulator* mainSim = Simulator::self();
+    if( jobs < 1 ) jobs = 1;
+
+    int total = m_variants.size();
+    for( int first=0; first<total; first+=jobs )
+    {
+        int last = std::min( first+jobs, total );
+
+        std::vector<job_t> batch( last-first );
+        for( int i=first; i<last; ++i )   // Circuits are created in GUI thread
+        {
+            job_t* job = &batch[i-first];
+            job->variant = i;
+            if( !startJob( job, circFile, mainSim ) )
+            {
+                for( int j=first; j<=i; ++j ) endJob( &batch[j-first] );
+                mainSim->makeCurrent();
+                return false;
+        }   }
+        QList<QFuture<void>> futures;   // Simulations run in parallel
+        for( job_t& job : batch ) futures.append( QtConcurrent::run( this, &Sweep::runJob, &job ) );
+        for( QFuture<void>& future : futures ) future.waitForFinished();
+
+        for( job_t& job : batch ) endJob( &job );
+
+        qDebug() << "Sweep: Variants done:" << last << "of" << total;
+    }
+    mainSim->makeCurrent();
+    return true;
+}
+
+bool Sweep::startJob( job_t* job, QString circFile, Simulator* mainSim )
+{
+    job->circuit = new Circuit( -1600, -1200, 3200, 2400, NULL ); // Current Circuit & Simulator in this thread
+    job->circuit->loadCircuit( circFile );
+    if( job->circuit->compList()->isEmpty() )
+    { qDebug() << "Error: Sweep::startJob: Could not load circuit:" << circFile; return false; }
+
+    Simulator* sim = job->circuit->simulator();
+    sim->setNlBatch( mainSim->nlBatch() );
+    Stimulus::self()->setRecord( false ); // Jobs must not overwrite the circuit recording
+
+    QHash<QString, CompBase*>* compMap = job->circuit->compMap();
+    QStringList& variant = m_variants[job->variant];
+    for( uint i=0; i<m_params.size(); ++i )
+    {
+        CompBase* comp = compMap->value( m_params[i].comp );
+        if( !comp || !comp->setPropStr( m_params[i].prop, variant.at(i) ) )
+        {
+            qDebug() << "Error: Sweep::startJob: Can't set" << m_params[i].comp << m_params[i].prop;
+            return false;
+    }   }
+    for( observe_t& observ : m_observs ) job->pins.push_back( job->circuit->getPin( observ.pin ) );
+
+    sim->startHeadless();
+    return true;
+}
+
+void Sweep::runJob( job_t* job )
+{
+    Simulator* sim = job->circuit->simulator();
+    std::vector<double>& results = m_results[job->variant];
+    std::vector<uint> next( m_observs.size(), 0 ); // Next sample of each observation
+
+    for( uint64_t time : m_times )
+    {
+        uint64_t circTime = sim->circTime()-1;  // Simulation starts at 1 ps
+        if( time > circTime ) sim->runFor( time-circTime, true );
+        if( sim->error() ) break;
+
+        int column = 0;
+        for( uint o=0; o<m_observs.size(); ++o )
+        {
+            std::vector<uint64_t>& times = m_observs[o].times;
+            if( next[o] < times.size() && times[next[o]] == time )
+            {
+                Pin* pin = job->pins[o];
+                if( pin && pin->isConnected() ) results[column+next[o]] = pin->getVoltage();
+                next[o]++;
+            }
+            column += times.size();
+    }   }
+    if     ( sim->error()       ) m_status[job->variant] = sim->errorText();
+    else if( sim->warning() > 0 ) m_status[job->variant] = sim->warningText();
+}
+
+void Sweep::endJob( job_t* job )
+{
+    if( !job->circuit ) return;
+    Simulator* sim = job->circuit->simulator();
+    sim->makeCurrent();
+    sim->stopSim();
+    job->circuit->clearCircuit();
+    delete job->circuit;
+    job->circuit = NULL;
+}
+
+bool Sweep::writeResults( QString fileName )
+{
+    QFile file( fileName );
+    if( fileName.isEmpty() ) file.open( stdout, QFile::WriteOnly | QFile::Text );
+    else if( !file.open( QFile::WriteOnly | QFile::Text ) )
+    { qDebug() << "Error: Sweep::writeResults: Cannot write file" << fileName; return false; }
+
+    QTextStream out( &file );
+    out << "Variant";
+    for( param_t& param : m_params ) out << ",\"" << param.comp << " " << param.prop << "\"";
+    for( observe_t& observ : m_observs )
+    {
+        if( observ.times.size() == 1 ) out << ",\"" << observ.name << "\"";
+        else for( uint64_t time : observ.times ) out << ",\"" << observ.name << "@" << time/1e12 << "\"";
+    }
+    out << ",Status\n";
+
+    for( uint v=0; v<m_variants.size(); ++v )
+    {
+        out << v;
+        for( const QString& value : m_variants[v] ) out << ",\"" << value << "\"";
+        for( double value : m_results[v] )
+        {
+            out << ",";
+            if( !std::isnan( value ) ) out << QString::number( value, 'g', 10 );
+        }
+        out << ",\"" << m_status[v] << "\"\n";
+    }
+    out.flush();
+    file.close();
+    return true;
+}
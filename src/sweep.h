@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Santiago González                               *
+ *                                                                         *
+ ***( see copyright.txt file at root folder )*******************************/
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <QStringList>
+#include <vector>
+
+class Circuit;
+class Pin;
+class Simulator;
+
+// Parameter sweep and Monte Carlo runner, used from headless mode:
+// simulide --headless circuit.sim1 --sweep spec.xml [--out results.csv] [--jobs N]
+//
+// Spec file:
+// <sweep time="10ms" runs="20" seed="1">
+//   <param comp="Resistor-1" prop="Resistance" values="1 kΩ;2.2 kΩ;4.7 kΩ"/>
+//   <param comp="Clock-1"    prop="Freq" from="1" to="100" steps="5" log="1" unit="kHz"/>
+//   <param comp="Resistor-2" prop="Resistance" tolerance="5" dist="gauss"/>
+//   <observe name="Vout"  pin="Resistor-1-rPin" time="5ms"/>
+//   <observe name="Scope" probe="Probe-1" step="1ms"/>
+// </sweep>
+//
+// "values" params are set as they are (any property: firmware file, model...),
+// "from/to" and "tolerance" params are numbers in the property unit.
+// If "unit" or "nominal" are not given, the values in the circuit file are used.
+// Variants: every combination of values/ranges, "runs" times each (tolerances are random in each run).
+// Tolerance in %: uniform distribution or gauss with tolerance = 3 sigma.
+// Observations: pin voltage at "time" (default end of simulation) or every "step".
+//
+// Each variant is an independent Circuit and Simulator, "jobs" variants run in parallel.
+
+class Sweep
+{
+    public:
+        Sweep();
+        ~Sweep();
+
+        bool loadSpec( QString fileName ); // Check params in the circuit already loaded
+        bool run( QString circFile, int jobs );
+        bool writeResults( QString fileName ); // CSV, stdout if no file
+
+        uint64_t simTime() { return m_simTime; }
+        int variants() { return m_variants.size(); }
+
+    private:
+        struct param_t
+        {
+            QString comp;
+            QString prop;
+            QString unit;
+            QStringList values; // Values list or range
+            double nominal;     // Tolerance params
+            double tolerance;
+            bool   gauss;
+        };
+        struct observe_t
+        {
+            QString name;
+            QString pin;
+            std::vector<uint64_t> times;
+        };
+        struct job_t
+        {
+            int variant;
+            Circuit* circuit;
+            std::vector<Pin*> pins;  // One for each observation
+        };
+
+        void createVariants();
+        bool startJob( job_t* job, QString circFile, Simulator* mainSim ); // GUI thread
+        void runJob( job_t* job );  // Any thread
+        void endJob( job_t* job );  // GUI thread
+
+        uint64_t m_simTime;
+        int      m_runs;
+        uint32_t m_seed;
+
+        std::vector<param_t>   m_params;
+        std::vector<observe_t> m_observs;
+        std::vector<uint64_t>  m_times;   // All sample times, sorted
+
+        std::vector<QStringList> m_variants;          // Param values for each variant
+        std::vector<std::vector<double>> m_results;  // Observed values for each variant
+        std::vector<QString> m_status;               // Simulation error or warning for each variant
+};
+
+#endif